@@ -0,0 +1,70 @@
+-- title: VBank ping-pong mark
+-- desc: Benchmarking tool to see how fast the vbanks can be switched while drawing, using Lua.
+-- license: MIT License
+-- input: gamepad
+-- script: lua
+-- version: 1.0.0
+
+screenWidth = 240
+screenHeight = 136
+toolbarHeight = 6
+switches = 1000
+t = 0
+
+FPS = {}
+
+function FPS:new(o)
+	o = o or {}
+	setmetatable(o, self)
+	self.__index = self
+	self.value = 0
+	self.frames = 0
+	self.lastTime = 0
+	return FPS
+end
+
+function FPS:getValue()
+	if (time() - self.lastTime <= 1000) then
+		self.frames = self.frames + 1
+	else
+		self.value = self.frames
+		self.frames = 0
+		self.lastTime = time()
+	end
+	return self.value
+end
+
+fps = FPS:new()
+
+function TIC()
+	t = t + 1
+
+	-- Input
+	if btn(0) then
+		switches = switches + 100
+	end
+	if btn(1) and switches > 100 then
+		switches = switches - 100
+	end
+
+	vbank(1)
+	cls(0)
+	vbank(0)
+	cls(15)
+
+	-- Draw, switching the bank before every pixel
+	for i = 0, switches - 1 do
+		vbank(i % 2)
+		pix((i * 7 + t) % screenWidth, toolbarHeight + (i * 13) % (screenHeight - toolbarHeight), 1 + i % 14)
+	end
+
+	vbank(0)
+	rect(0, 0, screenWidth, toolbarHeight, 0)
+	print("Switches: " .. switches, 1, 0, 11, false, 1, false)
+	print("FPS: " .. fps:getValue(), screenWidth / 2, 0, 11, false, 1, false)
+end
+
+-- <PALETTE>
+-- 000:1a1c2c5d275db13e53ef7d57ffcd75a7f07038b76425717929366f3b5dc941a6f673eff7f4f4f494b0c2566c86333c57
+-- 001:1a1c2c5d275db13e53ef7d57ffcd75a7f07038b76425717929366f3b5dc941a6f673eff7f4f4f494b0c2566c86333c57
+-- </PALETTE>
@@ -47,12 +47,14 @@ extern "C" {
 #define TIC80_SAMPLESIZE        sizeof(TIC80_SAMPLETYPE)
 #define TIC80_SAMPLE_CHANNELS   2
 #define TIC80_FRAMERATE         60
+#define TIC80_INDEX8_COLORS     32
 
 typedef enum {
     TIC80_PIXEL_COLOR_ARGB8888 = (1 << 8) | 32,
     TIC80_PIXEL_COLOR_ABGR8888 = (2 << 8) | 32,
     TIC80_PIXEL_COLOR_RGBA8888 = (3 << 8) | 32,
-    TIC80_PIXEL_COLOR_BGRA8888 = (4 << 8) | 32
+    TIC80_PIXEL_COLOR_BGRA8888 = (4 << 8) | 32,
+    TIC80_PIXEL_COLOR_INDEX8   = (5 << 8) | 8,
 } tic80_pixel_color_format;
 
 typedef struct 
@@ -71,6 +73,12 @@ typedef struct
     } samples;
 
     u32 *screen;
+
+    // TIC80_PIXEL_COLOR_INDEX8 only: screen holds one byte per pixel where 0..15
+    // index the vbank0 palette and 16..31 the vbank1 palette, palettes holds
+    // these TIC80_INDEX8_COLORS RGB triplets for every one of TIC80_FULLHEIGHT rows
+    // as they were after the SCN/BDR callbacks of the row
+    u8 *palettes;
 } tic80;
 
 typedef union
@@ -174,12 +182,29 @@ typedef struct
 
 } tic80_input;
 
+typedef enum
+{
+    TIC80_STEP_DEFAULT      = 0,
+    TIC80_STEP_SKIP_BLIT    = 1 << 0, // leave tic80.screen untouched, SCN/BDR callbacks are not called
+    TIC80_STEP_SKIP_SOUND   = 1 << 1, // leave tic80.samples untouched, music and sfx state still advance
+} tic80_step_flags;
+
 TIC80_API tic80* tic80_create(s32 samplerate, tic80_pixel_color_format format);
 TIC80_API void tic80_load(tic80* tic, void* cart, s32 size);
 TIC80_API void tic80_tick(tic80* tic, tic80_input input, u64 (*counter)(), u64 (*freq)());
 TIC80_API void tic80_sound(tic80* tic);
+
+// tic80_tick + tic80_sound in one call, with optional parts of the frame
+// skipped for simulation workloads that only inspect RAM or every Nth frame
+TIC80_API void tic80_step(tic80* tic, tic80_input input, u64 (*counter)(), u64 (*freq)(), u32 flags);
 TIC80_API void tic80_delete(tic80* tic);
 
+// trades ttri perspective correction accuracy for speed, see tic_core_perspective
+TIC80_API void tic80_perspective(tic80* tic, s32 span);
+
+// collects the script garbage after each step within the budget in microseconds, see tic_core_gc
+TIC80_API void tic80_gc(tic80* tic, s32 budget);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,76 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "tic80.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Steps N cart instances in lockstep on a pool of worker threads.
+// Every instance runs on a virtual 60Hz clock (time() advances by one frame
+// per step), so runs are reproducible no matter how fast they are stepped.
+// Only carts in languages without global VM state can be stepped in parallel:
+// Lua, Fennel, MoonScript, JS, Squirrel, Scheme and WASM. Python is not one of them,
+// its binding and the interpreter share interned names across the VMs.
+
+typedef struct tic80_batch tic80_batch;
+
+typedef enum
+{
+    TIC80_BATCH_OBS_NONE,
+    TIC80_BATCH_OBS_SCREEN, // TIC80_FULLWIDTH x TIC80_FULLHEIGHT pixels in the batch format,
+                            // one byte per pixel for TIC80_PIXEL_COLOR_INDEX8
+    TIC80_BATCH_OBS_RAM,    // a [offset, offset + size) slice of the 96K RAM
+} tic80_batch_obs;
+
+typedef enum
+{
+    TIC80_BATCH_RUNNING = 0,
+    TIC80_BATCH_EXITED  = 1 << 0, // the cart called exit()
+    TIC80_BATCH_ERROR   = 1 << 1, // the cart raised an error
+} tic80_batch_status_flags;
+
+// threads == 0 uses one thread per CPU, threads == 1 steps on the calling thread only
+TIC80_API tic80_batch* tic80_batch_create(s32 count, s32 threads, tic80_pixel_color_format format);
+TIC80_API void tic80_batch_delete(tic80_batch* batch);
+
+// loads the same cart into every instance and resets them
+TIC80_API void tic80_batch_load(tic80_batch* batch, void* cart, s32 size);
+TIC80_API void tic80_batch_reset(tic80_batch* batch, s32 index);
+TIC80_API tic80* tic80_batch_get(tic80_batch* batch, s32 index);
+TIC80_API u32 tic80_batch_status(tic80_batch* batch, s32 index);
+
+// selects what tic80_batch_step writes per instance, returns its size in bytes
+TIC80_API s32 tic80_batch_observe(tic80_batch* batch, tic80_batch_obs type, s32 offset, s32 size);
+
+// inputs holds one tic80_input per instance, observations is a caller buffer of
+// count * (size returned by tic80_batch_observe) bytes, instance by instance;
+// flags are tic80_step_flags. Stopped instances are not stepped until reset.
+// Callbacks in tic80_batch_get(...)->callback are called from the worker threads.
+TIC80_API void tic80_batch_step(tic80_batch* batch, const tic80_input* inputs, void* observations, u32 flags);
+
+#ifdef __cplusplus
+}
+#endif
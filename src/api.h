@@ -112,6 +112,21 @@ typedef struct
 
     s32 api_keywordsCount;
     const char** api_keywords;
+
+    // runtime version of the compiled chunks the script caches, NULL if it doesn't compile to bytecode,
+    // a cart keeps the chunk for the same runtime only
+    const char* bytecodeVersion;
+
+    // collector of the script heap, paced by the core after the frames, see tic_core_gc
+    struct
+    {
+        // does a bit of collection work, returns true when the cycle is over
+        bool (*step)(tic_mem* memory);
+        // bytes the script heap holds
+        u64 (*heap)(tic_mem* memory);
+        // the runtime collects by itself only when the heap grows past the limit, 0 gives it back its own pacing
+        void (*limit)(tic_mem* memory, u64 bytes);
+    } gc;
     
 } tic_script_config;
 
@@ -173,6 +188,29 @@ enum
     macro(BDR, BDR_FN "(row)", "Allows you to execute code between the drawing of each fullscreen scanline, "       \
         "for example, to manipulate the palette.")
 
+// BATCH COMMANDS TABLE, see batch()
+//  macro
+//  (
+//      name
+//      opcode
+//      parameters count
+//  )
+#define TIC_BATCH_LIST(macro)   \
+    macro(pix,      0, 3)       \
+    macro(line,     1, 5)       \
+    macro(rect,     2, 5)       \
+    macro(rectb,    3, 5)       \
+    macro(circ,     4, 4)       \
+    macro(circb,    5, 4)       \
+    macro(spr,      6, 9)
+
+enum
+{
+#define TIC_BATCH_DEF(NAME, OPCODE, _) tic_batch_##NAME = OPCODE,
+    TIC_BATCH_LIST(TIC_BATCH_DEF)
+#undef TIC_BATCH_DEF
+};
+
 // API DEFINITION TABLE
 //  macro
 //  (
@@ -382,6 +420,22 @@ enum
         u8* trans_colors, u8 trans_count, s32 scale, RemapFunc remap, void* data)                                       \
                                                                                                                         \
                                                                                                                         \
+    macro(remap,                                                                                                        \
+        "remap(tile index flip=0 rotate=0 frames=1 ticks=1) -> ok\nremap()",                                            \
+                                                                                                                        \
+        "Sets how map() draws the cells with the given tile without calling back into the script: "                     \
+        "the tile is replaced with `index` and flipped and rotated like in spr().\n"                                    \
+        "With more than one frame it cycles through the tiles index..index+frames-1, "                                  \
+        "showing each of them for `ticks` frames, to animate water or conveyors.\n"                                     \
+        "The table is applied before the remap callback of map(), which gets the replaced tile.\n"                      \
+        "Calling remap() with no parameters draws all the tiles as they are again.",                                    \
+        6,                                                                                                              \
+        0,                                                                                                              \
+        0,                                                                                                              \
+        bool,                                                                                                           \
+        tic_mem*, s32 tile, s32 index, u8 flip, u8 rotate, s32 frames, s32 ticks)                                       \
+                                                                                                                        \
+                                                                                                                        \
     macro(mget,                                                                                                         \
         "mget(x y) -> tile_id",                                                                                         \
                                                                                                                         \
@@ -407,6 +461,82 @@ enum
         tic_mem*, s32 x, s32 y, u8 value)                                                                               \
                                                                                                                         \
                                                                                                                         \
+    macro(mflag,                                                                                                        \
+        "mflag(x y w h flag) -> bool",                                                                                  \
+                                                                                                                        \
+        "Returns true if any map tile under the rectangle of pixels has the sprite flag set, "                          \
+        "the same as checking every tile with `mget()` and `fget()` but in one call.\n"                                 \
+        "The map coordinates are in pixels, 8 per tile, and the area outside the map is empty.",                        \
+        5,                                                                                                              \
+        5,                                                                                                              \
+        0,                                                                                                              \
+        bool,                                                                                                           \
+        tic_mem*, s32 x, s32 y, s32 w, s32 h, s32 flag)                                                                  \
+                                                                                                                        \
+                                                                                                                        \
+    macro(mray,                                                                                                         \
+        "mray(x0 y0 x1 y1 flag) -> cell",                                                                               \
+                                                                                                                        \
+        "Walks the map tiles along the line between two points in pixels and "                                          \
+        "returns the first one with the sprite flag set, as a cell index `x + y * 240`, or -1 if there is none.\n"      \
+        "The area outside the map is empty.",                                                                           \
+        5,                                                                                                              \
+        5,                                                                                                              \
+        0,                                                                                                              \
+        s32,                                                                                                            \
+        tic_mem*, float x0, float y0, float x1, float y1, s32 flag)                                                      \
+                                                                                                                        \
+                                                                                                                        \
+    macro(mrect,                                                                                                        \
+        "mrect(x y w h) -> tile_ids",                                                                                   \
+                                                                                                                        \
+        "Returns the tile ids of the map rectangle row by row, the same as `mget()` would return for each of them.\n"   \
+        "The rectangle is limited to the size of the map.",                                                             \
+        4,                                                                                                              \
+        4,                                                                                                              \
+        0,                                                                                                              \
+        s32,                                                                                                            \
+        tic_mem*, s32 x, s32 y, s32 w, s32 h, u8* tiles)                                                                \
+                                                                                                                        \
+                                                                                                                        \
+    macro(path,                                                                                                         \
+        "path(x0 y0 x1 y1 flag) -> cells",                                                                              \
+                                                                                                                        \
+        "Finds the shortest path between two map cells with A*, stepping up, down, left and right "                     \
+        "over the tiles that don't have the sprite flag set.\n"                                                         \
+        "Returns the cells after the start up to the goal as `x + y * 240`, or nothing if the goal can't be reached.",  \
+        5,                                                                                                              \
+        5,                                                                                                              \
+        0,                                                                                                              \
+        s32,                                                                                                            \
+        tic_mem*, s32 x0, s32 y0, s32 x1, s32 y1, s32 flag, const u16** cells)                                           \
+                                                                                                                        \
+                                                                                                                        \
+    macro(flow,                                                                                                         \
+        "flow(x y flag) -> count",                                                                                      \
+                                                                                                                        \
+        "Computes the steps from every map cell to the target cell, "                                                   \
+        "over the tiles that don't have the sprite flag set, so many actors can follow it with `flowstep()`.\n"         \
+        "Returns the count of cells the target can be reached from.",                                                   \
+        3,                                                                                                              \
+        3,                                                                                                              \
+        0,                                                                                                              \
+        s32,                                                                                                            \
+        tic_mem*, s32 x, s32 y, s32 flag)                                                                                \
+                                                                                                                        \
+                                                                                                                        \
+    macro(flowstep,                                                                                                     \
+        "flowstep(x y) -> cell",                                                                                        \
+                                                                                                                        \
+        "Returns the neighbour cell one step closer to the target of the last `flow()` as `x + y * 240`, "              \
+        "the cell itself at the target or -1 if the target can't be reached from it.",                                  \
+        2,                                                                                                              \
+        2,                                                                                                              \
+        0,                                                                                                              \
+        s32,                                                                                                            \
+        tic_mem*, s32 x, s32 y)                                                                                         \
+                                                                                                                        \
+                                                                                                                        \
     macro(peek,                                                                                                         \
         "peek(addr bits=8) -> value",                                                                                   \
                                                                                                                         \
@@ -732,6 +862,22 @@ enum
         tic_mem*, s32 x, s32 y, s32 width, s32 height)                                                                  \
                                                                                                                         \
                                                                                                                         \
+    macro(canvas,                                                                                                       \
+        "canvas(id w=1 h=1) -> ok\ncanvas()",                                                                           \
+                                                                                                                        \
+        "Redirects all drawing to an off-screen surface of w*h tiles until `canvas()` is called "                       \
+        "or the frame ends, then packs it to the block of the sprite sheet starting at tile `id`.\n"                    \
+        "Draw a static composition once and blit it back with `spr(id,x,y,-1,1,0,0,w,h)`\n"                             \
+        "instead of redrawing it every frame.\n"                                                                        \
+        "The surface starts blank and drawing is clipped to it, the block is always in the 4bpp layout.\n"              \
+        "Returns false if the block doesn't fit the sheet or is higher than the screen.",                               \
+        3,                                                                                                              \
+        0,                                                                                                              \
+        0,                                                                                                              \
+        bool,                                                                                                           \
+        tic_mem*, s32 index, s32 w, s32 h)                                                                              \
+                                                                                                                        \
+                                                                                                                        \
     macro(music,                                                                                                        \
         "music(track=-1 frame=-1 row=-1 loop=true sustain=false tempo=-1 speed=-1)",                                    \
                                                                                                                         \
@@ -815,7 +961,7 @@ enum
         2,                                                                                                              \
         0,                                                                                                              \
         bool,                                                                                                           \
-        tic_mem*, s32 index, u8 flag)                                                                                   \
+        tic_mem*, s32 index, s32 flag)                                                                                   \
                                                                                                                         \
                                                                                                                         \
     macro(fset,                                                                                                         \
@@ -829,12 +975,89 @@ enum
         3,                                                                                                              \
         0,                                                                                                              \
         void,                                                                                                           \
-        tic_mem*, s32 index, u8 flag, bool value)
+        tic_mem*, s32 index, s32 flag, bool value)                                                                       \
+                                                                                                                        \
+                                                                                                                        \
+    macro(batch,                                                                                                        \
+        "batch(commands) -> count",                                                                                     \
+                                                                                                                        \
+        "Draws a whole list of primitives in one call, which saves the per call overhead "                              \
+        "when there are thousands of particles or bullets to draw.\n"                                                   \
+        "The commands are a flat array of numbers, each command is an opcode followed by its parameters:\n"             \
+        "- 0 = pix x y color\n"                                                                                         \
+        "- 1 = line x0 y0 x1 y1 color\n"                                                                                \
+        "- 2 = rect x y w h color\n"                                                                                    \
+        "- 3 = rectb x y w h color\n"                                                                                   \
+        "- 4 = circ x y radius color\n"                                                                                 \
+        "- 5 = circb x y radius color\n"                                                                                \
+        "- 6 = spr id x y colorkey scale flip rotate w h\n"                                                             \
+        "Use a colorkey of -1 for an opaque sprite.\n"                                                                  \
+        "Drawing stops at the first unknown or incomplete command or at a number that isn't finite "                    \
+        "or is out of the integer range, "                                                                              \
+        "the function returns the number of commands drawn.",                                                           \
+        1,                                                                                                              \
+        1,                                                                                                              \
+        0,                                                                                                              \
+        s32,                                                                                                            \
+        tic_mem*, const float* commands, s32 count)                                                                     \
+                                                                                                                        \
+                                                                                                                        \
+    macro(raster,                                                                                                       \
+        "raster(row addr value) -> ok\nraster()",                                                                       \
+                                                                                                                        \
+        "Writes the VRAM byte of the current vbank at the address right before the fullscreen row is drawn, "           \
+        "the same as `BDR()` would do with `poke()` but without calling back into the script.\n"                        \
+        "The address is the palette 0x3FC0..0x3FEF, the border color 0x3FF8 or the screen offset 0x3FF9 and 0x3FFA.\n"  \
+        "The writes stay in the table until `raster()` clears it, only the drawing sees them, so "                      \
+        "`peek()`, `SCN()` and `BDR()` still read and write the VRAM values of the script.\n"                           \
+        "Returns false if the row or address is out of range or the table is full.",                                    \
+        3,                                                                                                              \
+        0,                                                                                                              \
+        0,                                                                                                              \
+        bool,                                                                                                           \
+        tic_mem*, s32 row, s32 address, s32 value)
 
 #define TIC_API_DEF(name, _, __, ___, ____, _____, ret, ...) ret tic_api_##name(__VA_ARGS__);
 TIC_API_LIST(TIC_API_DEF)
 #undef TIC_API_DEF
 
+typedef struct
+{
+    struct
+    {
+        u64 rows;       // rows blitted, borders included
+        u64 skipped;    // rows left as they were since nothing changed in them
+        u64 palettes;   // vbank palettes expanded to the screen format
+    } blit;
+
+    struct
+    {
+        u64 hits;       // tiles drawn from the unpacked tiles cache
+        u64 misses;     // tiles unpacked from RAM into the cache
+    } tiles;
+
+    struct
+    {
+        u64 hits;       // map cells drawn from the unpacked map chunks
+        u64 misses;     // map cells unpacked into the chunks
+    } map;
+
+    struct
+    {
+        u64 time;       // microseconds spent collecting after the frames
+        u64 frame;      // microseconds spent collecting after the last frame
+        u64 heap;       // bytes the script heap holds after the last frame
+        u64 cycles;     // collection cycles finished after the frames
+    } gc;
+
+    struct
+    {
+        u64 live;       // bytes the script VM holds
+        u64 peak;       // most bytes it held since the cart started
+        u64 cap;        // limit set by the `memory` metatag in MB, 0 if there is none
+    } heap;
+} tic_stats;
+
 struct tic_mem
 {
     tic80           product;
@@ -864,6 +1087,8 @@ struct tic_mem
 
         u8 data;
     } input;
+
+    tic_stats stats;
 };
 
 tic_mem* tic_core_create(s32 samplerate, tic80_pixel_color_format format);
@@ -873,11 +1098,40 @@ void tic_core_resume(tic_mem* memory);
 void tic_core_tick_start(tic_mem* memory);
 void tic_core_tick(tic_mem* memory, tic_tick_data* data);
 void tic_core_tick_end(tic_mem* memory);
+// ticks the cart, then blits and makes the sound of the frame unless tic80_step_flags skip them
+void tic_core_step(tic_mem* memory, tic_tick_data* data, u32 flags);
 void tic_core_synth_sound(tic_mem* tic);
+void tic_core_skip_sound(tic_mem* tic);
 void tic_core_blit(tic_mem* tic);
 void tic_core_blit_ex(tic_mem* tic, tic_blit_callback clb);
+// forces the next blit to redraw the rows, call it after drawing over product.screen
+// or writing to ram->vram.screen directly, bypassing the tic_api_* functions
+void tic_core_blit_invalidate(tic_mem* tic, s32 row, s32 count);
+// drops the unpacked tiles [tile, tile + count) of the cache, call it after writing
+// to ram->tiles or ram->sprites directly, sprites are numbered after the tiles
+void tic_core_tiles_invalidate(tic_mem* tic, s32 tile, s32 count);
+// ttri with depth divides the texture coords by z only every `span` pixels and
+// interpolates linearly between, 0 or 1 keeps the exact per pixel division
+void tic_core_perspective(tic_mem* tic, s32 span);
+// collects the script garbage after each frame for up to `budget` microseconds instead of
+// whenever the runtime allocates, 0 leaves it to the runtime
+void tic_core_gc(tic_mem* tic, s32 budget);
 const tic_script_config* tic_core_script_config(tic_mem* memory);
+// stores the chunk compiled by the last run in cart.bytecode, so the next start skips the compiler, returns false
+// and clears it if the script has no bytecode, the code has changed since the run or there is no key to sign it
+bool tic_core_bytecode_store(tic_mem* memory);
+// the runtimes load bytecode without verifying it, so a crafted chunk can corrupt memory, cart.bytecode
+// is used only if it's signed with this key, a secret of the install, or it's trusted with tic_core_bytecode_trust
+#define TIC_BYTECODE_KEY 16
+void tic_core_bytecode_key(tic_mem* memory, const u8* key);
+// trusts the given bytecode whatever cart it comes in, for the cart the app is built with, like the one
+// embedded in an exported player, never for the carts loaded from anywhere else
+void tic_core_bytecode_trust(tic_mem* memory, const tic_binary* bytecode);
+// tic_api_vbank only flips the bank pointers, this brings the active vbank
+// back to ram->vram for the code that accesses it directly
+void tic_core_vbank_sync(tic_mem* tic);
 
 #define VBANK(tic, bank)                                \
     bool MACROVAR(_bank_) = tic_api_vbank(tic, bank);   \
-    SCOPE(tic_api_vbank(tic, MACROVAR(_bank_)))
+    tic_core_vbank_sync(tic);                           \
+    SCOPE(tic_api_vbank(tic, MACROVAR(_bank_)), tic_core_vbank_sync(tic))
@@ -44,12 +44,70 @@ static const char* execute_fennel_src = FENNEL_CODE(
   if(not ok) then return msg end
 );
 
+static const char* setup_fennel_src = FENNEL_CODE(
+  io = { read = true }
+  debug.traceback = require("fennel").traceback
+);
+
+// takes the options fennel.eval would, strict mode checks the globals against the current ones,
+// the Lua source starts with the sourcemap of its lines, so the traceback maps the lines of
+// the cached chunk back to the code too
+static const char* compile_fennel_src = FENNEL_CODE(
+  local fennel = require("fennel")
+  local compiler = require("fennel.compiler")
+  local opts = {allowedGlobals = false, filename = "(fennel)", ["error-pinpoint"]={">>", "<<"}}
+  local src = ...
+  if(src:find("\n;; +strict: *true")) then opts.allowedGlobals = require("fennel.specials")["current-global-names"]() end
+  local ok, lua = pcall(fennel.compileString, src, opts)
+  if(not ok) then return ok, lua end
+  local map, lines = compiler.sourcemap["@" .. opts.filename], {}
+  for i, line in ipairs(map) do
+    lines[i] = string.format("{%s,%s}", line[1] and string.format("%q", line[1]):gsub("\n", "n") or "nil", tostring(line[2]))
+  end
+  return true, string.format("require(%q).sourcemap[%q] = {short_src = %q, key = %q, %s}; ",
+    "fennel.compiler", map.key, map.short_src, map.key, table.concat(lines, ",")) .. lua
+);
+
+// compiles the code to Lua, or loads the chunk compiled from the same code by the previous run,
+// so the cart restarts without going through the Fennel compiler again
+static bool loadFennelCode(tic_core* core, lua_State* fennel, const char* code)
+{
+    if(loadLuaChunk(core, fennel, code))
+        return true;
+
+    if (luaL_loadbuffer(fennel, compile_fennel_src, strlen(compile_fennel_src), "compile_fennel") != LUA_OK)
+    {
+        core->data->error(core->data->data, "failed to load fennel compiler");
+        return false;
+    }
+
+    lua_pushstring(fennel, code);
+    lua_call(fennel, 1, 2);
+
+    size_t size;
+    const char* source = lua_tolstring(fennel, -1, &size);
+
+    if (!lua_toboolean(fennel, -2))
+    {
+        core->data->error(core->data->data, source);
+        return false;
+    }
+
+    if (compileLuaChunk(core, fennel, code, source, size, "@(fennel)") != LUA_OK)
+    {
+        core->data->error(core->data->data, lua_tostring(fennel, -1));
+        return false;
+    }
+
+    return true;
+}
+
 static bool initFennel(tic_mem* tic, const char* code)
 {
     tic_core* core = (tic_core*)tic;
     closeLua(tic);
 
-    lua_State* lua = core->currentVM = luaL_newstate();
+    lua_State* lua = core->currentVM = newLuaState(core);
     lua_open_builtins(lua);
 
     initLuaAPI(core);
@@ -68,19 +126,20 @@ static bool initFennel(tic_mem* tic, const char* code)
 
         lua_call(fennel, 0, 0);
 
-        if (luaL_loadbuffer(fennel, execute_fennel_src, strlen(execute_fennel_src), "execute_fennel") != LUA_OK)
+        if (luaL_loadbuffer(fennel, setup_fennel_src, strlen(setup_fennel_src), "setup_fennel") != LUA_OK)
         {
             core->data->error(core->data->data, "failed to load fennel compiler");
             return false;
         }
 
-        lua_pushstring(fennel, code);
-        lua_call(fennel, 1, 1);
-        const char* err = lua_tostring(fennel, -1);
+        lua_call(fennel, 0, 0);
+
+        if (!loadFennelCode(core, fennel, code))
+            return false;
 
-        if (err)
+        if (lua_pcall(fennel, 0, 0, 0) != LUA_OK)
         {
-            core->data->error(core->data->data, err);
+            core->data->error(core->data->data, lua_tostring(fennel, -1));
             return false;
         }
     }
@@ -226,6 +285,15 @@ tic_script_config FennelSyntaxConfig =
     .keywordsCount      = COUNT_OF(FennelKeywords),
 
     .useStructuredEdition = true,
+
+    .bytecodeVersion    = LUA_RELEASE,
+
+    .gc =
+    {
+        .step           = stepLuaGC,
+        .heap           = getLuaHeap,
+        .limit          = limitLuaGC,
+    },
 };
 
 #endif /* defined(TIC_BUILD_WITH_FENNEL) */
@@ -43,8 +43,15 @@ static Janet janet_btn(int32_t argc, Janet* argv);
 static Janet janet_btnp(int32_t argc, Janet* argv);
 static Janet janet_sfx(int32_t argc, Janet* argv);
 static Janet janet_map(int32_t argc, Janet* argv);
+static Janet janet_remap(int32_t argc, Janet* argv);
 static Janet janet_mget(int32_t argc, Janet* argv);
 static Janet janet_mset(int32_t argc, Janet* argv);
+static Janet janet_mflag(int32_t argc, Janet* argv);
+static Janet janet_mray(int32_t argc, Janet* argv);
+static Janet janet_mrect(int32_t argc, Janet* argv);
+static Janet janet_path(int32_t argc, Janet* argv);
+static Janet janet_flow(int32_t argc, Janet* argv);
+static Janet janet_flowstep(int32_t argc, Janet* argv);
 static Janet janet_peek(int32_t argc, Janet* argv);
 static Janet janet_poke(int32_t argc, Janet* argv);
 static Janet janet_peek1(int32_t argc, Janet* argv);
@@ -70,6 +77,7 @@ static Janet janet_tri(int32_t argc, Janet* argv);
 static Janet janet_trib(int32_t argc, Janet* argv);
 static Janet janet_ttri(int32_t argc, Janet* argv);
 static Janet janet_clip(int32_t argc, Janet* argv);
+static Janet janet_canvas(int32_t argc, Janet* argv);
 static Janet janet_music(int32_t argc, Janet* argv);
 static Janet janet_sync(int32_t argc, Janet* argv);
 static Janet janet_vbank(int32_t argc, Janet* argv);
@@ -78,6 +86,8 @@ static Janet janet_key(int32_t argc, Janet* argv);
 static Janet janet_keyp(int32_t argc, Janet* argv);
 static Janet janet_fget(int32_t argc, Janet* argv);
 static Janet janet_fset(int32_t argc, Janet* argv);
+static Janet janet_batch(int32_t argc, Janet* argv);
+static Janet janet_raster(int32_t argc, Janet* argv);
 
 static void closeJanet(tic_mem* tic);
 static bool initJanet(tic_mem* tic, const char* code);
@@ -105,8 +115,15 @@ static const JanetReg janet_c_functions[] =
     {"btnp", janet_btnp, NULL},
     {"sfx", janet_sfx, NULL},
     {"map", janet_map, NULL},
+    {"remap", janet_remap, NULL},
     {"mget", janet_mget, NULL},
     {"mset", janet_mset, NULL},
+    {"mflag", janet_mflag, NULL},
+    {"mray", janet_mray, NULL},
+    {"mrect", janet_mrect, NULL},
+    {"path", janet_path, NULL},
+    {"flow", janet_flow, NULL},
+    {"flowstep", janet_flowstep, NULL},
     {"peek", janet_peek, NULL},
     {"poke", janet_poke, NULL},
     {"peek1", janet_peek1, NULL},
@@ -132,6 +149,7 @@ static const JanetReg janet_c_functions[] =
     {"trib", janet_trib, NULL},
     {"ttri", janet_ttri, NULL},
     {"clip", janet_clip, NULL},
+    {"canvas", janet_canvas, NULL},
     {"music", janet_music, NULL},
     {"sync", janet_sync, NULL},
     {"vbank", janet_vbank, NULL},
@@ -140,6 +158,8 @@ static const JanetReg janet_c_functions[] =
     {"keyp", janet_keyp, NULL},
     {"fget", janet_fget, NULL},
     {"fset", janet_fset, NULL},
+    {"batch", janet_batch, NULL},
+    {"raster", janet_raster, NULL},
     {NULL, NULL, NULL}
 };
 
@@ -524,6 +544,24 @@ static Janet janet_map(int32_t argc, Janet* argv)
     return janet_wrap_nil();
 }
 
+static Janet janet_remap(int32_t argc, Janet* argv)
+{
+    janet_arity(argc, 0, 6);
+
+    if (argc == 1)
+        janet_panic("Error: must provide 0 or at least 2 args.");
+
+    s32 tile = (s32)janet_optinteger(argv, argc, 0, -1);
+    s32 index = (s32)janet_optinteger(argv, argc, 1, 0);
+    u8 flip = (u8)janet_optinteger(argv, argc, 2, 0);
+    u8 rotate = (u8)janet_optinteger(argv, argc, 3, 0);
+    s32 frames = (s32)janet_optinteger(argv, argc, 4, 1);
+    s32 ticks = (s32)janet_optinteger(argv, argc, 5, 1);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+    return janet_wrap_boolean(tic_api_remap(memory, tile, index, flip, rotate, frames, ticks));
+}
+
 static Janet janet_mget(int32_t argc, Janet* argv)
 {
     janet_fixarity(argc, 2);
@@ -548,6 +586,108 @@ static Janet janet_mset(int32_t argc, Janet* argv)
     return janet_wrap_nil();
 }
 
+static Janet janet_mflag(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 5);
+
+    s32 x = (s32)janet_getinteger(argv, 0);
+    s32 y = (s32)janet_getinteger(argv, 1);
+    s32 w = (s32)janet_getinteger(argv, 2);
+    s32 h = (s32)janet_getinteger(argv, 3);
+    s32 flag = janet_getinteger(argv, 4);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+    return janet_wrap_boolean(tic_api_mflag(memory, x, y, w, h, flag));
+}
+
+static Janet janet_mray(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 5);
+
+    float x0 = janet_getnumber(argv, 0);
+    float y0 = janet_getnumber(argv, 1);
+    float x1 = janet_getnumber(argv, 2);
+    float y1 = janet_getnumber(argv, 3);
+    s32 flag = janet_getinteger(argv, 4);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+    return janet_wrap_integer(tic_api_mray(memory, x0, y0, x1, y1, flag));
+}
+
+static Janet janet_mrect(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 4);
+
+    s32 x = (s32)janet_getinteger(argv, 0);
+    s32 y = (s32)janet_getinteger(argv, 1);
+    s32 w = (s32)janet_getinteger(argv, 2);
+    s32 h = (s32)janet_getinteger(argv, 3);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+
+    s32 count = tic_api_mrect(memory, x, y, w, h, NULL);
+    u8* tiles = malloc(count + 1);
+
+    if (!tiles)
+        janet_panic("out of memory");
+
+    tic_api_mrect(memory, x, y, w, h, tiles);
+
+    JanetArray* result = janet_array(count);
+
+    for (s32 i = 0; i < count; i++)
+        janet_array_push(result, janet_wrap_integer(tiles[i]));
+
+    free(tiles);
+    return janet_wrap_array(result);
+}
+
+static Janet janet_path(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 5);
+
+    s32 x0 = (s32)janet_getinteger(argv, 0);
+    s32 y0 = (s32)janet_getinteger(argv, 1);
+    s32 x1 = (s32)janet_getinteger(argv, 2);
+    s32 y1 = (s32)janet_getinteger(argv, 3);
+    s32 flag = janet_getinteger(argv, 4);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+
+    const u16* cells;
+    s32 count = tic_api_path(memory, x0, y0, x1, y1, flag, &cells);
+
+    JanetArray* result = janet_array(count);
+
+    for (s32 i = 0; i < count; i++)
+        janet_array_push(result, janet_wrap_integer(cells[i]));
+
+    return janet_wrap_array(result);
+}
+
+static Janet janet_flow(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 3);
+
+    s32 x = (s32)janet_getinteger(argv, 0);
+    s32 y = (s32)janet_getinteger(argv, 1);
+    s32 flag = janet_getinteger(argv, 2);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+    return janet_wrap_integer(tic_api_flow(memory, x, y, flag));
+}
+
+static Janet janet_flowstep(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 2);
+
+    s32 x = (s32)janet_getinteger(argv, 0);
+    s32 y = (s32)janet_getinteger(argv, 1);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+    return janet_wrap_integer(tic_api_flowstep(memory, x, y));
+}
+
 static Janet janet_peek(int32_t argc, Janet* argv)
 {
     janet_arity(argc, 1, 2);
@@ -936,6 +1076,18 @@ static Janet janet_clip(int32_t argc, Janet* argv)
     return janet_wrap_nil();
 }
 
+static Janet janet_canvas(int32_t argc, Janet* argv)
+{
+    janet_arity(argc, 0, 3);
+
+    s32 index = (s32)janet_optinteger(argv, argc, 0, -1);
+    s32 w = (s32)janet_optinteger(argv, argc, 1, 1);
+    s32 h = (s32)janet_optinteger(argv, argc, 2, 1);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+    return janet_wrap_boolean(tic_api_canvas(memory, index, w, h));
+}
+
 static Janet janet_music(int32_t argc, Janet* argv)
 {
     janet_arity(argc, 0, 7);
@@ -1016,7 +1168,7 @@ static Janet janet_fget(int32_t argc, Janet* argv)
     janet_fixarity(argc, 2);
 
     s32 index = janet_getinteger(argv, 0);
-    u8 flag = janet_getinteger(argv, 1);
+    s32 flag = janet_getinteger(argv, 1);
 
     tic_mem* memory = (tic_mem*)getJanetMachine();
     return janet_wrap_boolean(tic_api_fget(memory, index, flag));
@@ -1028,7 +1180,7 @@ static Janet janet_fset(int32_t argc, Janet* argv)
     janet_fixarity(argc, 3);
 
     s32 index = janet_getinteger(argv, 0);
-    u8 flag = janet_getinteger(argv, 1);
+    s32 flag = janet_getinteger(argv, 1);
     bool value = janet_getboolean(argv, 2);
 
     tic_mem* memory = (tic_mem*)getJanetMachine();
@@ -1036,6 +1188,46 @@ static Janet janet_fset(int32_t argc, Janet* argv)
     return janet_wrap_nil();
 }
 
+static Janet janet_batch(int32_t argc, Janet* argv)
+{
+    janet_fixarity(argc, 1);
+
+    JanetView list = janet_getindexed(argv, 0);
+    float* commands = list.len ? malloc(list.len * sizeof *commands) : NULL;
+    s32 done = 0;
+
+    if (commands)
+    {
+        for (s32 i = 0; i < list.len; i++)
+            commands[i] = janet_checktype(list.items[i], JANET_NUMBER)
+                ? (float)janet_unwrap_number(list.items[i]) : 0;
+
+        tic_mem* memory = (tic_mem*)getJanetMachine();
+        done = tic_api_batch(memory, commands, list.len);
+        free(commands);
+    }
+
+    return janet_wrap_integer(done);
+}
+
+static Janet janet_raster(int32_t argc, Janet* argv)
+{
+    janet_arity(argc, 0, 3);
+
+    tic_mem* memory = (tic_mem*)getJanetMachine();
+
+    if (argc == 0)
+        return janet_wrap_boolean(tic_api_raster(memory, -1, 0, 0));
+
+    janet_fixarity(argc, 3);
+
+    s32 row = janet_getinteger(argv, 0);
+    s32 address = janet_getinteger(argv, 1);
+    s32 value = janet_getinteger(argv, 2);
+
+    return janet_wrap_boolean(tic_api_raster(memory, row, address, value));
+}
+
 /* ***************** */
 static void reportError(tic_core* core, Janet result)
 {
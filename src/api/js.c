@@ -30,6 +30,11 @@
 #include <string.h>
 #include <quickjs.h>
 
+// set by the build from the QuickJS sources
+#if !defined(CONFIG_VERSION)
+#define CONFIG_VERSION "unknown"
+#endif
+
 static inline tic_core* getCore(JSContext *ctx)
 {
     return JS_GetContextOpaque(ctx);
@@ -110,6 +115,72 @@ static void js_std_dump_error(JSContext *ctx)
     JS_FreeValue(ctx, exception_val);
 }
 
+// the runtime allocates from the core heap, so the cart's memory is pooled and counted,
+// QuickJS frees the blocks without their size, so every block starts with it
+typedef union
+{
+    size_t size;
+    double align[2];
+} JsBlock;
+
+static inline size_t jsBlockSize(const void* ptr)
+{
+    return ((const JsBlock*)ptr - 1)->size;
+}
+
+static void* jsRealloc(JSMallocState* s, void* ptr, size_t size)
+{
+    if(!ptr && !size)
+        return NULL;
+
+    size_t old = ptr ? jsBlockSize(ptr) : 0;
+
+    if(size > old && s->malloc_size + size - old > s->malloc_limit)
+        return NULL;
+
+    JsBlock* block = tic_core_heap_realloc(s->opaque, ptr ? (JsBlock*)ptr - 1 : NULL,
+        ptr ? sizeof(JsBlock) + old : 0, size ? sizeof(JsBlock) + size : 0);
+
+    if(size && !block)
+        return NULL;
+
+    if(ptr)
+    {
+        s->malloc_count--;
+        s->malloc_size -= sizeof(JsBlock) + old;
+    }
+
+    if(size)
+    {
+        s->malloc_count++;
+        s->malloc_size += sizeof(JsBlock) + size;
+    }
+
+    if(!size)
+        return NULL;
+
+    block->size = size;
+    return block + 1;
+}
+
+static void* jsMalloc(JSMallocState* s, size_t size)
+{
+    return jsRealloc(s, NULL, size);
+}
+
+static void jsFree(JSMallocState* s, void* ptr)
+{
+    jsRealloc(s, ptr, 0);
+}
+
+static const JSMallocFunctions JsMallocFunctions =
+{
+    jsMalloc,
+    jsFree,
+    jsRealloc,
+    jsBlockSize,
+};
+
 static void closeJavascript(tic_mem* tic)
 {
     tic_core* core = (tic_core*)tic;
@@ -124,6 +195,30 @@ static void closeJavascript(tic_mem* tic)
     }
 }
 
+// QuickJS frees most of the garbage by reference counting, the collection only finds the cycles
+// and can't be split, so it's done as a whole in one step
+static bool stepJavascriptGC(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+
+    JS_RunGC(JS_GetRuntime(core->currentVM));
+
+    return true;
+}
+
+static u64 getJavascriptHeap(tic_mem* tic)
+{
+    return tic->stats.heap.live;
+}
+
+static void limitJavascriptGC(tic_mem* tic, u64 bytes)
+{
+    tic_core* core = (tic_core*)tic;
+
+    // 256K is the QuickJS default threshold, it grows by itself after the collections
+    JS_SetGCThreshold(JS_GetRuntime(core->currentVM), bytes ? (size_t)bytes : 256 * 1024);
+}
+
 static JSValue js_print(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
 {
     tic_mem* tic = (tic_mem*)getCore(ctx);
@@ -219,7 +314,7 @@ static JSValue js_rectb(JSContext *ctx, JSValueConst this_val, s32 argc, JSValue
 
 static JSValue js_spr(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
 {
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     s32 index = getInteger2(ctx, argv[0], 0);
@@ -449,7 +544,7 @@ static JSValue js_map(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueCo
     s32 sy = getInteger2(ctx, argv[5], 0);
     s32 scale = getInteger2(ctx, argv[7], 1);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     if(JS_IsArray(ctx, argv[6]))
@@ -482,6 +577,20 @@ static JSValue js_map(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueCo
     return JS_UNDEFINED;
 }
 
+static JSValue js_remap(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 tile = getInteger2(ctx, argv[0], -1);
+    s32 index = getInteger2(ctx, argv[1], 0);
+    u8 flip = getInteger2(ctx, argv[2], 0);
+    u8 rotate = getInteger2(ctx, argv[3], 0);
+    s32 frames = getInteger2(ctx, argv[4], 1);
+    s32 ticks = getInteger2(ctx, argv[5], 1);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    return JS_NewBool(ctx, tic_api_remap(tic, tile, index, flip, rotate, frames, ticks));
+}
+
 static JSValue js_mget(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
 {
     s32 x = getInteger2(ctx, argv[0], 0);
@@ -506,6 +615,101 @@ static JSValue js_mset(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     return JS_UNDEFINED;
 }
 
+static JSValue js_mflag(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 x = getInteger2(ctx, argv[0], 0);
+    s32 y = getInteger2(ctx, argv[1], 0);
+    s32 w = getInteger2(ctx, argv[2], 0);
+    s32 h = getInteger2(ctx, argv[3], 0);
+    s32 flag = getInteger2(ctx, argv[4], 0);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    return JS_NewBool(ctx, tic_api_mflag(tic, x, y, w, h, flag));
+}
+
+static JSValue js_mray(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    float x0 = getNumber(ctx, argv[0]);
+    float y0 = getNumber(ctx, argv[1]);
+    float x1 = getNumber(ctx, argv[2]);
+    float y1 = getNumber(ctx, argv[3]);
+    s32 flag = getInteger2(ctx, argv[4], 0);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    return JS_NewInt32(ctx, tic_api_mray(tic, x0, y0, x1, y1, flag));
+}
+
+static JSValue js_mrect(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 x = getInteger2(ctx, argv[0], 0);
+    s32 y = getInteger2(ctx, argv[1], 0);
+    s32 w = getInteger2(ctx, argv[2], 0);
+    s32 h = getInteger2(ctx, argv[3], 0);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+    u8* tiles = js_malloc(ctx, count + 1);
+
+    if(!tiles)
+        return JS_EXCEPTION;
+
+    tic_api_mrect(tic, x, y, w, h, tiles);
+
+    JSValue arr = JS_NewArray(ctx);
+
+    for(s32 i = 0; i < count; i++)
+        JS_SetPropertyUint32(ctx, arr, i, JS_NewInt32(ctx, tiles[i]));
+
+    js_free(ctx, tiles);
+
+    return arr;
+}
+
+static JSValue js_path(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 x0 = getInteger2(ctx, argv[0], 0);
+    s32 y0 = getInteger2(ctx, argv[1], 0);
+    s32 x1 = getInteger2(ctx, argv[2], 0);
+    s32 y1 = getInteger2(ctx, argv[3], 0);
+    s32 flag = getInteger2(ctx, argv[4], 0);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    const u16* cells;
+    s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+    JSValue arr = JS_NewArray(ctx);
+
+    for(s32 i = 0; i < count; i++)
+        JS_SetPropertyUint32(ctx, arr, i, JS_NewInt32(ctx, cells[i]));
+
+    return arr;
+}
+
+static JSValue js_flow(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 x = getInteger2(ctx, argv[0], 0);
+    s32 y = getInteger2(ctx, argv[1], 0);
+    s32 flag = getInteger2(ctx, argv[2], 0);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    return JS_NewInt32(ctx, tic_api_flow(tic, x, y, flag));
+}
+
+static JSValue js_flowstep(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 x = getInteger2(ctx, argv[0], 0);
+    s32 y = getInteger2(ctx, argv[1], 0);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    return JS_NewInt32(ctx, tic_api_flowstep(tic, x, y));
+}
+
 static JSValue js_peek(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
 {
     s32 address = getInteger(ctx, argv[0]);
@@ -810,7 +1014,7 @@ static JSValue js_textri(JSContext *ctx, JSValueConst this_val, s32 argc, JSValu
     tic_mem* tic = (tic_mem*)getCore(ctx);
     bool use_map = JS_ToBool(ctx, argv[12]);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
     if(JS_IsArray(ctx, argv[13]))
     {
@@ -852,7 +1056,7 @@ static JSValue js_ttri(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     tic_mem* tic = (tic_mem*)getCore(ctx);
     tic_texture_src src = getInteger(ctx, argv[12]);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
     if(JS_IsArray(ctx, argv[13]))
     {
@@ -906,6 +1110,17 @@ static JSValue js_clip(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     return JS_UNDEFINED;
 }
 
+static JSValue js_canvas(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    s32 index = getInteger2(ctx, argv[0], -1);
+    s32 w = getInteger2(ctx, argv[1], 1);
+    s32 h = getInteger2(ctx, argv[2], 1);
+
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    return JS_NewBool(ctx, tic_api_canvas(tic, index, w, h));
+}
+
 static JSValue js_music(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
 {
     tic_mem* tic = (tic_mem*)getCore(ctx);
@@ -977,7 +1192,7 @@ static JSValue js_fget(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     tic_mem* tic = (tic_mem*)getCore(ctx);
 
     u32 index = getInteger2(ctx, argv[0], 0);
-    u32 flag = getInteger2(ctx, argv[1], 0);
+    s32 flag = getInteger2(ctx, argv[1], 0);
 
     bool value = tic_api_fget(tic, index, flag);
 
@@ -989,7 +1204,7 @@ static JSValue js_fset(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     tic_mem* tic = (tic_mem*)getCore(ctx);
 
     u32 index = getInteger2(ctx, argv[0], 0);
-    u32 flag = getInteger2(ctx, argv[1], 0);
+    s32 flag = getInteger2(ctx, argv[1], 0);
     bool value = JS_ToBool(ctx, argv[2]);
 
     tic_api_fset(tic, index, flag, value);
@@ -997,14 +1212,128 @@ static JSValue js_fset(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueC
     return JS_UNDEFINED;
 }
 
+static bool isFloat32Array(JSContext *ctx, JSValueConst val)
+{
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue ctor = JS_GetPropertyStr(ctx, global, "Float32Array");
+    s32 res = JS_IsInstanceOf(ctx, val, ctor);
+
+    JS_FreeValue(ctx, ctor);
+    JS_FreeValue(ctx, global);
+
+    if(res < 0)
+        JS_FreeValue(ctx, JS_GetException(ctx));
+
+    return res > 0;
+}
+
+static JSValue js_batch(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    // a Float32Array is drawn right from its buffer
+    if(isFloat32Array(ctx, argv[0]))
+    {
+        size_t offset, length, element, size;
+        JSValue buffer = JS_GetTypedArrayBuffer(ctx, argv[0], &offset, &length, &element);
+
+        if(JS_IsException(buffer))
+            return buffer;
+
+        const u8* data = JS_GetArrayBuffer(ctx, &size, buffer);
+        s32 done = data && element == sizeof(float) && offset + length <= size
+            ? tic_api_batch(tic, (const float*)(data + offset), (s32)(length / sizeof(float)))
+            : 0;
+
+        JS_FreeValue(ctx, buffer);
+
+        return JS_NewInt32(ctx, done);
+    }
+
+    // plain arrays and the other typed arrays are read element by element
+    JSValue length = JS_GetPropertyStr(ctx, argv[0], "length");
+    s32 count = getInteger2(ctx, length, 0);
+    JS_FreeValue(ctx, length);
+
+    if(count <= 0)
+        return JS_NewInt32(ctx, 0);
+
+    float* commands = js_malloc(ctx, count * sizeof *commands);
+
+    if(!commands)
+        return JS_EXCEPTION;
+
+    for(s32 i = 0; i < count; i++)
+    {
+        JSValue val = JS_GetPropertyUint32(ctx, argv[0], i);
+        commands[i] = getNumber(ctx, val);
+        JS_FreeValue(ctx, val);
+    }
+
+    s32 done = tic_api_batch(tic, commands, count);
+    js_free(ctx, commands);
+
+    return JS_NewInt32(ctx, done);
+}
+
+static JSValue js_raster(JSContext *ctx, JSValueConst this_val, s32 argc, JSValueConst *argv)
+{
+    tic_mem* tic = (tic_mem*)getCore(ctx);
+
+    if(argc == 0)
+        return JS_NewBool(ctx, tic_api_raster(tic, -1, 0, 0));
+
+    s32 row = getInteger2(ctx, argv[0], 0);
+    s32 address = getInteger2(ctx, argv[1], 0);
+    s32 value = getInteger2(ctx, argv[2], 0);
+
+    return JS_NewBool(ctx, tic_api_raster(tic, row, address, value));
+}
+
+// compiles the code, or reads the function compiled from the same code by the previous run
+// or stored in the cart, the compiled function is kept for the next run
+static JSValue compileJavascript(tic_core* core, JSContext* ctx, const char* code)
+{
+    s32 size;
+    const u8* compiled = tic_core_compiled(core, code, &size);
+
+    if(compiled)
+    {
+        JSValue func = JS_ReadObject(ctx, compiled, size, JS_READ_OBJ_BYTECODE);
+
+        if(!JS_IsException(func))
+            return func;
+
+        // the bytecode is rejected by this runtime, the code is compiled again
+        JS_FreeValue(ctx, JS_GetException(ctx));
+    }
+
+    JSValue func = JS_Eval(ctx, code, strlen(code), "index.js", JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+
+    if(!JS_IsException(func))
+    {
+        size_t length;
+        u8* data = JS_WriteObject(ctx, &length, func, JS_WRITE_OBJ_BYTECODE);
+
+        if(data)
+        {
+            tic_core_compiled_set(core, code, data, (s32)length);
+            js_free(ctx, data);
+        }
+    }
+
+    return func;
+}
+
 static bool initJavascript(tic_mem* tic, const char* code)
 {
     closeJavascript(tic);
 
-    JSRuntime *rt = JS_NewRuntime();
+    tic_core* core = (tic_core*)tic;
+
+    JSRuntime *rt = JS_NewRuntime2(&JsMallocFunctions, core);
     JSContext* ctx = JS_NewContext(rt);
 
-    tic_core* core = (tic_core*)tic;
     core->currentVM = ctx;
     JS_SetContextOpaque(ctx, core);
 
@@ -1025,7 +1354,8 @@ static bool initJavascript(tic_mem* tic, const char* code)
         JS_FreeValue(ctx, global);
     }
 
-    JSValue ret = JS_Eval(ctx, code, strlen(code), "index.js", JS_EVAL_TYPE_GLOBAL);
+    JSValue func = compileJavascript(core, ctx, code);
+    JSValue ret = JS_IsException(func) ? func : JS_EvalFunction(ctx, func);
     if (JS_IsException(ret))
     {
         js_std_dump_error(ctx);
@@ -1284,6 +1614,15 @@ const tic_script_config JsSyntaxConfig =
 
     .keywords           = JsKeywords,
     .keywordsCount      = COUNT_OF(JsKeywords),
+
+    .bytecodeVersion    = "QuickJS " CONFIG_VERSION,
+
+    .gc =
+    {
+        .step           = stepJavascriptGC,
+        .heap           = getJavascriptHeap,
+        .limit          = limitJavascriptGC,
+    },
 };
 
 #endif /* defined(TIC_BUILD_WITH_JS) */
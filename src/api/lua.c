@@ -25,6 +25,7 @@
 #if defined(TIC_BUILD_WITH_LUA)
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <lua.h>
 #include <lauxlib.h>
@@ -434,7 +435,7 @@ static s32 lua_textri(lua_State* lua)
             pt[i] = (float)lua_tonumber(lua, i + 1);
 
         tic_mem* tic = (tic_mem*)getLuaCore(lua);
-        static u8 colors[TIC_PALETTE_SIZE];
+        u8 colors[TIC_PALETTE_SIZE] = {0};
         s32 count = 0;
         bool use_map = false;
 
@@ -498,7 +499,7 @@ static s32 lua_ttri(lua_State* lua)
             pt[i] = (float)lua_tonumber(lua, i + 1);
 
         tic_mem* tic = (tic_mem*)getLuaCore(lua);
-        static u8 colors[TIC_PALETTE_SIZE];
+        u8 colors[TIC_PALETTE_SIZE] = {0};
         s32 count = 0;
         tic_texture_src src = tic_tiles_texture;
 
@@ -589,6 +590,31 @@ static s32 lua_clip(lua_State* lua)
     return 0;
 }
 
+static s32 lua_canvas(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+    if(top == 0)
+    {
+        lua_pushboolean(lua, tic_api_canvas(tic, -1, 0, 0));
+        return 1;
+    }
+    else if(top <= 3)
+    {
+        s32 index = getLuaNumber(lua, 1);
+        s32 w = top >= 2 ? getLuaNumber(lua, 2) : 1;
+        s32 h = top >= 3 ? getLuaNumber(lua, 3) : 1;
+
+        lua_pushboolean(lua, tic_api_canvas(tic, index, w, h));
+        return 1;
+    }
+    else luaL_error(lua, "invalid parameters, use canvas(id,w=1,h=1) or canvas()\n");
+
+    return 0;
+}
+
 static s32 lua_btnp(lua_State* lua)
 {
     tic_core* core = getLuaCore(lua);
@@ -660,7 +686,7 @@ static s32 lua_spr(lua_State* lua)
     s32 scale = 1;
     tic_flip flip = tic_no_flip;
     tic_rotate rotate = tic_no_rotate;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     if(top >= 1) 
@@ -768,6 +794,155 @@ static s32 lua_mset(lua_State* lua)
     return 0;
 }
 
+static s32 lua_mflag(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 5)
+    {
+        s32 x = getLuaNumber(lua, 1);
+        s32 y = getLuaNumber(lua, 2);
+        s32 w = getLuaNumber(lua, 3);
+        s32 h = getLuaNumber(lua, 4);
+        s32 flag = getLuaNumber(lua, 5);
+
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+        lua_pushboolean(lua, tic_api_mflag(tic, x, y, w, h, flag));
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, mflag(x,y,w,h,flag)\n");
+
+    return 0;
+}
+
+static s32 lua_mray(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 5)
+    {
+        float x0 = lua_tonumber(lua, 1);
+        float y0 = lua_tonumber(lua, 2);
+        float x1 = lua_tonumber(lua, 3);
+        float y1 = lua_tonumber(lua, 4);
+        s32 flag = getLuaNumber(lua, 5);
+
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+        lua_pushinteger(lua, tic_api_mray(tic, x0, y0, x1, y1, flag));
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, mray(x0,y0,x1,y1,flag)\n");
+
+    return 0;
+}
+
+static s32 lua_mrect(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 4)
+    {
+        s32 x = getLuaNumber(lua, 1);
+        s32 y = getLuaNumber(lua, 2);
+        s32 w = getLuaNumber(lua, 3);
+        s32 h = getLuaNumber(lua, 4);
+
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+        // the buffer is a userdata, so it counts toward the cart memory cap
+        // and the allocation error is raised by Lua
+        s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+        u8* tiles = lua_newuserdata(lua, count + 1);
+
+        tic_api_mrect(tic, x, y, w, h, tiles);
+        lua_createtable(lua, count, 0);
+
+        for(s32 i = 0; i < count; i++)
+        {
+            lua_pushinteger(lua, tiles[i]);
+            lua_rawseti(lua, -2, i + 1);
+        }
+
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, mrect(x,y,w,h)\n");
+
+    return 0;
+}
+
+static s32 lua_path(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 5)
+    {
+        s32 x0 = getLuaNumber(lua, 1);
+        s32 y0 = getLuaNumber(lua, 2);
+        s32 x1 = getLuaNumber(lua, 3);
+        s32 y1 = getLuaNumber(lua, 4);
+        s32 flag = getLuaNumber(lua, 5);
+
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+        const u16* cells;
+        s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+        lua_createtable(lua, count, 0);
+
+        for(s32 i = 0; i < count; i++)
+        {
+            lua_pushinteger(lua, cells[i]);
+            lua_rawseti(lua, -2, i + 1);
+        }
+
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, path(x0,y0,x1,y1,flag)\n");
+
+    return 0;
+}
+
+static s32 lua_flow(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 3)
+    {
+        s32 x = getLuaNumber(lua, 1);
+        s32 y = getLuaNumber(lua, 2);
+        s32 flag = getLuaNumber(lua, 3);
+
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+        lua_pushinteger(lua, tic_api_flow(tic, x, y, flag));
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, flow(x,y,flag)\n");
+
+    return 0;
+}
+
+static s32 lua_flowstep(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 2)
+    {
+        s32 x = getLuaNumber(lua, 1);
+        s32 y = getLuaNumber(lua, 2);
+
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+        lua_pushinteger(lua, tic_api_flowstep(tic, x, y));
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, flowstep(x,y)\n");
+
+    return 0;
+}
+
 typedef struct
 {
     lua_State* lua;
@@ -799,7 +974,7 @@ static s32 lua_map(lua_State* lua)
     s32 sx = 0;
     s32 sy = 0;
     s32 scale = 1;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     s32 top = lua_gettop(lua);
@@ -879,6 +1054,34 @@ static s32 lua_map(lua_State* lua)
     return 0;
 }
 
+static s32 lua_remap(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    tic_mem* tic = (tic_mem*)getLuaCore(lua);
+
+    if(top == 0)
+    {
+        lua_pushboolean(lua, tic_api_remap(tic, -1, 0, 0, 0, 1, 1));
+        return 1;
+    }
+    else if(top >= 2 && top <= 6)
+    {
+        s32 tile = getLuaNumber(lua, 1);
+        s32 index = getLuaNumber(lua, 2);
+        u8 flip = top >= 3 ? getLuaNumber(lua, 3) : 0;
+        u8 rotate = top >= 4 ? getLuaNumber(lua, 4) : 0;
+        s32 frames = top >= 5 ? getLuaNumber(lua, 5) : 1;
+        s32 ticks = top >= 6 ? getLuaNumber(lua, 6) : 1;
+
+        lua_pushboolean(lua, tic_api_remap(tic, tile, index, flip, rotate, frames, ticks));
+        return 1;
+    }
+    else luaL_error(lua, "invalid parameters, use remap(tile,index,flip=0,rotate=0,frames=1,ticks=1) or remap()\n");
+
+    return 0;
+}
+
 static s32 lua_music(lua_State* lua)
 {
     s32 top = lua_gettop(lua);
@@ -1445,7 +1648,7 @@ static s32 lua_fget(lua_State* lua)
 
         if(top >= 2)
         {
-            u32 flag = getLuaNumber(lua, 2);
+            s32 flag = getLuaNumber(lua, 2);
             lua_pushboolean(lua, tic_api_fget(tic, index, flag));
             return 1;
         }
@@ -1467,7 +1670,7 @@ static s32 lua_fset(lua_State* lua)
 
         if(top >= 2)
         {
-            u32 flag = getLuaNumber(lua, 2);
+            s32 flag = getLuaNumber(lua, 2);
 
             if(top >= 3)
             {
@@ -1483,6 +1686,62 @@ static s32 lua_fset(lua_State* lua)
     return 0;
 }
 
+static s32 lua_batch(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+
+    if(top == 1 && lua_istable(lua, 1))
+    {
+        tic_mem* tic = (tic_mem*)getLuaCore(lua);
+        s32 count = (s32)lua_rawlen(lua, 1);
+        float* commands = count ? malloc(count * sizeof *commands) : NULL;
+        s32 done = 0;
+
+        if(commands)
+        {
+            for(s32 i = 0; i < count; i++)
+            {
+                lua_rawgeti(lua, 1, i + 1);
+                commands[i] = (float)lua_tonumber(lua, -1);
+                lua_pop(lua, 1);
+            }
+
+            done = tic_api_batch(tic, commands, count);
+            free(commands);
+        }
+
+        lua_pushinteger(lua, done);
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, batch(commands)\n");
+
+    return 0;
+}
+
+static s32 lua_raster(lua_State* lua)
+{
+    tic_mem* tic = (tic_mem*)getLuaCore(lua);
+    s32 top = lua_gettop(lua);
+
+    if(top == 0)
+    {
+        lua_pushboolean(lua, tic_api_raster(tic, -1, 0, 0));
+        return 1;
+    }
+    else if(top >= 3)
+    {
+        s32 row = getLuaNumber(lua, 1);
+        s32 address = getLuaNumber(lua, 2);
+        s32 value = getLuaNumber(lua, 3);
+
+        lua_pushboolean(lua, tic_api_raster(tic, row, address, value));
+        return 1;
+    }
+    else luaL_error(lua, "invalid params, raster(row,addr,value)\n");
+
+    return 0;
+}
+
 static s32 lua_dofile(lua_State *lua)
 {
     luaL_error(lua, "unknown method: \"dofile\"\n");
@@ -1497,6 +1756,29 @@ static s32 lua_loadfile(lua_State *lua)
     return 0;
 }
 
+static void* allocLua(void* ud, void* ptr, size_t osize, size_t nsize)
+{
+    return tic_core_heap_realloc(ud, ptr, osize, nsize);
+}
+
+static s32 panicLua(lua_State* lua)
+{
+    const char* msg = lua_tostring(lua, -1);
+    fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n", msg ? msg : "error object is not a string");
+    return 0;
+}
+
+// the state allocates from the core heap, so the cart's memory is pooled and counted
+lua_State* newLuaState(tic_core* core)
+{
+    lua_State* lua = lua_newstate(allocLua, core);
+
+    if(lua)
+        lua_atpanic(lua, panicLua);
+
+    return lua;
+}
+
 void lua_open_builtins(lua_State *lua)
 {
     static const luaL_Reg loadedlibs[] =
@@ -1549,13 +1831,108 @@ void closeLua(tic_mem* tic)
     }
 }
 
+bool stepLuaGC(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+
+    return lua_gc(core->currentVM, LUA_GCSTEP, 0);
+}
+
+u64 getLuaHeap(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+    lua_State* lua = core->currentVM;
+
+    return (u64)lua_gc(lua, LUA_GCCOUNT, 0) * 1024 + lua_gc(lua, LUA_GCCOUNTB, 0);
+}
+
+// 200 is the Lua default pause, the collector can't wait longer than 1000
+enum {LuaGCPause = 200, LuaGCMaxPause = 1000};
+
+// the runtime starts a cycle by itself when the heap grows past the pause percent of the heap
+// the last cycle left, so the pause makes it wait for `bytes` while the frames collect
+void limitLuaGC(tic_mem* tic, u64 bytes)
+{
+    tic_core* core = (tic_core*)tic;
+    s32 pause = bytes
+        ? (s32)CLAMP(bytes * 100 / MAX(core->gc.live, 1), LuaGCPause, LuaGCMaxPause)
+        : LuaGCPause;
+
+    lua_gc(core->currentVM, LUA_GCINC, pause, 0, 0);
+}
+
+typedef struct
+{
+    u8* data;
+    s32 size;
+} LuaChunk;
+
+static s32 writeLuaChunk(lua_State* lua, const void* data, size_t size, void* userdata)
+{
+    LuaChunk* chunk = userdata;
+    u8* grown = realloc(chunk->data, chunk->size + size);
+
+    if(!grown)
+        return 1;
+
+    memcpy(grown + chunk->size, data, size);
+    chunk->data = grown;
+    chunk->size += (s32)size;
+
+    return 0;
+}
+
+// loads the chunk compiled from the same code by the previous run,
+// the debug info is kept in the chunk, so the errors point to the same lines
+bool loadLuaChunk(tic_core* core, lua_State* lua, const char* code)
+{
+    s32 size;
+    const void* compiled = tic_core_compiled(core, code, &size);
+
+    if(compiled)
+    {
+        if(luaL_loadbufferx(lua, compiled, size, "compiled", "b") == LUA_OK)
+            return true;
+
+        lua_pop(lua, 1);
+    }
+
+    return false;
+}
+
+// compiles the Lua source made from the code and keeps the chunk for the next run with the same code,
+// the name is stored in the chunk, so keep it short, the line info stays for the error messages
+s32 compileLuaChunk(tic_core* core, lua_State* lua, const char* code, const char* source, size_t size, const char* name)
+{
+    s32 status = luaL_loadbuffer(lua, source, size, name);
+
+    if(status == LUA_OK)
+    {
+        LuaChunk chunk = {NULL, 0};
+
+        if(lua_dump(lua, writeLuaChunk, &chunk, 0) == 0)
+            tic_core_compiled_set(core, code, chunk.data, chunk.size);
+
+        free(chunk.data);
+    }
+
+    return status;
+}
+
+static s32 loadLuaCode(tic_core* core, lua_State* lua, const char* code)
+{
+    return loadLuaChunk(core, lua, code)
+        ? LUA_OK
+        : compileLuaChunk(core, lua, code, code, strlen(code), "=code");
+}
+
 static bool initLua(tic_mem* tic, const char* code)
 {
     tic_core* core = (tic_core*)tic;
 
     closeLua(tic);
 
-    lua_State* lua = core->currentVM = luaL_newstate();
+    lua_State* lua = core->currentVM = newLuaState(core);
     lua_open_builtins(lua);
 
     initLuaAPI(core);
@@ -1565,7 +1942,7 @@ static bool initLua(tic_mem* tic, const char* code)
 
         lua_settop(lua, 0);
 
-        if(luaL_loadstring(lua, code) != LUA_OK || lua_pcall(lua, 0, LUA_MULTRET, 0) != LUA_OK)
+        if(loadLuaCode(core, lua, code) != LUA_OK || lua_pcall(lua, 0, LUA_MULTRET, 0) != LUA_OK)
         {
             core->data->error(core->data->data, lua_tostring(lua, -1));
             return false;
@@ -1823,6 +2200,15 @@ tic_script_config LuaSyntaxConfig =
 
     .keywords           = LuaKeywords,
     .keywordsCount      = COUNT_OF(LuaKeywords),
+
+    .bytecodeVersion    = LUA_RELEASE,
+
+    .gc =
+    {
+        .step           = stepLuaGC,
+        .heap           = getLuaHeap,
+        .limit          = limitLuaGC,
+    },
 };
 
 #endif /* defined(TIC_BUILD_WITH_LUA) */
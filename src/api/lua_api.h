@@ -41,4 +41,10 @@ extern void callLuaOverline(tic_mem* tic, void* data);
 extern void callLuaMenu(tic_mem* tic, s32 index, void* data);
 extern void closeLua(tic_mem* tic);
 extern void callLuaTick(tic_mem* tic);
+extern lua_State* newLuaState(tic_core* core);
 extern void lua_open_builtins(lua_State *lua);
+extern bool stepLuaGC(tic_mem* tic);
+extern u64 getLuaHeap(tic_mem* tic);
+extern void limitLuaGC(tic_mem* tic, u64 bytes);
+extern bool loadLuaChunk(tic_core* core, lua_State* lua, const char* code);
+extern s32 compileLuaChunk(tic_core* core, lua_State* lua, const char* code, const char* source, size_t size, const char* name);
@@ -46,6 +46,48 @@ static const char* execute_moonscript_src = MOON_CODE(
     return fn()
 );
 
+static const char* compile_moonscript_src = MOON_CODE(
+    local code, err = require('moonscript.base').to_lua(...)
+
+    if not code then
+        error(err)
+    end
+    return code
+);
+
+// compiles the code to Lua, or loads the chunk compiled from the same code by the previous run,
+// so the cart restarts without going through the MoonScript compiler again
+static bool loadMoonscriptCode(tic_core* core, lua_State* moon, const char* code)
+{
+    if(loadLuaChunk(core, moon, code))
+        return true;
+
+    if (luaL_loadbuffer(moon, compile_moonscript_src, strlen(compile_moonscript_src), "compile_moonscript") != LUA_OK)
+    {
+        core->data->error(core->data->data, "failed to load moonscript compiler");
+        return false;
+    }
+
+    lua_pushstring(moon, code);
+    if (lua_pcall(moon, 1, 1, 0) != LUA_OK)
+    {
+        core->data->error(core->data->data, lua_tostring(moon, -1));
+        return false;
+    }
+
+    size_t size;
+    const char* source = lua_tolstring(moon, -1, &size);
+
+    // same chunk name as moonscript.base.loadstring gives it
+    if (compileLuaChunk(core, moon, code, source, size, "=(moonscript.loadstring)") != LUA_OK)
+    {
+        core->data->error(core->data->data, lua_tostring(moon, -1));
+        return false;
+    }
+
+    return true;
+}
+
 static void setloaded(lua_State* l, char* name)
 {
     s32 top = lua_gettop(l);
@@ -83,7 +125,7 @@ static bool initMoonscript(tic_mem* tic, const char* code)
     tic_core* core = (tic_core*)tic;
     closeLua(tic);
 
-    lua_State* lua = core->currentVM = luaL_newstate();
+    lua_State* lua = core->currentVM = newLuaState(core);
     lua_open_builtins(lua);
 
     luaopen_lpeg(lua);
@@ -111,10 +153,11 @@ static bool initMoonscript(tic_mem* tic, const char* code)
         }
 
         lua_setglobal(lua, _ms_loadstring);
-        lua_getglobal(lua, _ms_loadstring);
 
-        lua_pushstring(moon, code);
-        if (lua_pcall(moon, 1, 1, 0) != LUA_OK)
+        if (!loadMoonscriptCode(core, moon, code))
+            return false;
+
+        if (lua_pcall(moon, 0, 1, 0) != LUA_OK)
         {
             const char* msg = lua_tostring(moon, -1);
 
@@ -224,6 +267,15 @@ tic_script_config MoonSyntaxConfig =
 
     .keywords           = MoonKeywords,
     .keywordsCount      = COUNT_OF(MoonKeywords),
+
+    .bytecodeVersion    = LUA_RELEASE,
+
+    .gc =
+    {
+        .step           = stepLuaGC,
+        .heap           = getLuaHeap,
+        .limit          = limitLuaGC,
+    },
 };
 
 #endif /* defined(TIC_BUILD_WITH_MOON) */
@@ -50,6 +50,12 @@ static inline tic_core* getMRubyMachine(mrb_state* mrb)
     return CurrentMachine;
 }
 
+// mrb_int is wider than the s32 flag, clamp it to keep huge flags out of range instead of wrapping
+static inline s32 getFlag(mrb_int flag)
+{
+    return (s32)CLAMP(flag, -1, BITS_IN_BYTE);
+}
+
 static mrb_value mrb_peek(mrb_state* mrb, mrb_value self)
 {
     tic_core* machine = getMRubyMachine(mrb);
@@ -362,6 +368,16 @@ static mrb_value mrb_clip(mrb_state* mrb, mrb_value self)
     return mrb_nil_value();
 }
 
+static mrb_value mrb_canvas(mrb_state* mrb, mrb_value self)
+{
+    mrb_int index = -1, w = 1, h = 1;
+    mrb_get_args(mrb, "|iii", &index, &w, &h);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    return mrb_bool_value(tic_api_canvas(memory, index, w, h));
+}
+
 static mrb_value mrb_btnp(mrb_state* mrb, mrb_value self)
 {
     tic_core* machine = getMRubyMachine(mrb);
@@ -418,7 +434,7 @@ static mrb_value mrb_spr(mrb_state* mrb, mrb_value self)
     mrb_int w = 1, h = 1, scale = 1;
     mrb_int flip = tic_no_flip, rotate = tic_no_rotate;
     mrb_value colors_obj;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     mrb_int count = 0;
 
     mrb_int argc = mrb_get_args(mrb, "iii|oiiiii", &index, &x, &y, &colors_obj, &scale, &flip, &rotate, &w, &h);
@@ -470,6 +486,87 @@ static mrb_value mrb_mset(mrb_state* mrb, mrb_value self)
     return mrb_nil_value();
 }
 
+static mrb_value mrb_mflag(mrb_state* mrb, mrb_value self)
+{
+    mrb_int x, y, w, h, flag;
+    mrb_get_args(mrb, "iiiii", &x, &y, &w, &h, &flag);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    return mrb_bool_value(tic_api_mflag(memory, x, y, w, h, getFlag(flag)));
+}
+
+static mrb_value mrb_mray(mrb_state* mrb, mrb_value self)
+{
+    mrb_float x0, y0, x1, y1;
+    mrb_int flag;
+    mrb_get_args(mrb, "ffffi", &x0, &y0, &x1, &y1, &flag);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    return mrb_fixnum_value(tic_api_mray(memory, x0, y0, x1, y1, getFlag(flag)));
+}
+
+static mrb_value mrb_mrect(mrb_state* mrb, mrb_value self)
+{
+    mrb_int x, y, w, h;
+    mrb_get_args(mrb, "iiii", &x, &y, &w, &h);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    s32 count = tic_api_mrect(memory, x, y, w, h, NULL);
+    u8* tiles = mrb_malloc(mrb, count + 1);
+
+    tic_api_mrect(memory, x, y, w, h, tiles);
+
+    mrb_value result = mrb_ary_new_capa(mrb, count);
+
+    for (s32 i = 0; i < count; ++i)
+        mrb_ary_push(mrb, result, mrb_fixnum_value(tiles[i]));
+
+    mrb_free(mrb, tiles);
+
+    return result;
+}
+
+static mrb_value mrb_path(mrb_state* mrb, mrb_value self)
+{
+    mrb_int x0, y0, x1, y1, flag;
+    mrb_get_args(mrb, "iiiii", &x0, &y0, &x1, &y1, &flag);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    const u16* cells;
+    s32 count = tic_api_path(memory, x0, y0, x1, y1, getFlag(flag), &cells);
+
+    mrb_value result = mrb_ary_new_capa(mrb, count);
+
+    for (s32 i = 0; i < count; ++i)
+        mrb_ary_push(mrb, result, mrb_fixnum_value(cells[i]));
+
+    return result;
+}
+
+static mrb_value mrb_flow(mrb_state* mrb, mrb_value self)
+{
+    mrb_int x, y, flag;
+    mrb_get_args(mrb, "iii", &x, &y, &flag);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    return mrb_fixnum_value(tic_api_flow(memory, x, y, getFlag(flag)));
+}
+
+static mrb_value mrb_flowstep(mrb_state* mrb, mrb_value self)
+{
+    mrb_int x, y;
+    mrb_get_args(mrb, "ii", &x, &y);
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    return mrb_fixnum_value(tic_api_flowstep(memory, x, y));
+}
+
 static mrb_value mrb_tstamp(mrb_state* mrb, mrb_value self)
 {
     tic_mem* tic = (tic_mem*)getMRubyMachine(mrb);
@@ -502,7 +599,7 @@ static mrb_value mrb_fget(mrb_state* mrb, mrb_value self)
 
     tic_mem* tic = (tic_mem*)getMRubyMachine(mrb);
 
-    return mrb_bool_value(tic_api_fget(tic, index, flag));
+    return mrb_bool_value(tic_api_fget(tic, index, getFlag(flag)));
 }
 
 static mrb_value mrb_fset(mrb_state* mrb, mrb_value self)
@@ -513,11 +610,56 @@ static mrb_value mrb_fset(mrb_state* mrb, mrb_value self)
 
     tic_mem* tic = (tic_mem*)getMRubyMachine(mrb);
 
-    tic_api_fset(tic, index, flag, value);
+    tic_api_fset(tic, index, getFlag(flag), value);
 
     return mrb_nil_value();
 }
 
+static mrb_value mrb_batch(mrb_state* mrb, mrb_value self)
+{
+    mrb_value commands_obj;
+    mrb_get_args(mrb, "A", &commands_obj);
+
+    mrb_int count = ARY_LEN(RARRAY(commands_obj));
+    float* commands = count ? malloc(count * sizeof(float)) : NULL;
+    mrb_int done = 0;
+
+    if (commands)
+    {
+        for (mrb_int i = 0; i < count; ++i)
+        {
+            mrb_value value = mrb_ary_entry(commands_obj, i);
+            commands[i] = mrb_float_p(value) ? mrb_float(value)
+                : mrb_fixnum_p(value) ? mrb_integer(value) : 0;
+        }
+
+        tic_mem* tic = (tic_mem*)getMRubyMachine(mrb);
+
+        done = tic_api_batch(tic, commands, count);
+        free(commands);
+    }
+
+    return mrb_fixnum_value(done);
+}
+
+static mrb_value mrb_raster(mrb_state* mrb, mrb_value self)
+{
+    mrb_int row, address, value;
+    mrb_int argc = mrb_get_args(mrb, "|iii", &row, &address, &value);
+
+    tic_mem* tic = (tic_mem*)getMRubyMachine(mrb);
+
+    if (argc == 0)
+        return mrb_bool_value(tic_api_raster(tic, -1, 0, 0));
+    else if (argc < 3)
+    {
+        mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid params, raster(row, addr, value)");
+        return mrb_nil_value();
+    }
+
+    return mrb_bool_value(tic_api_raster(tic, row, address, value));
+}
+
 typedef struct
 {
     mrb_state* mrb;
@@ -607,6 +749,19 @@ static mrb_value mrb_map(mrb_state* mrb, mrb_value self)
     return mrb_nil_value();
 }
 
+static mrb_value mrb_remap(mrb_state* mrb, mrb_value self)
+{
+    mrb_int tile = -1, index = 0, flip = 0, rotate = 0, frames = 1, ticks = 1;
+    mrb_int argc = mrb_get_args(mrb, "|iiiiii", &tile, &index, &flip, &rotate, &frames, &ticks);
+
+    if(argc == 1)
+        mrb_raise(mrb, E_ARGUMENT_ERROR, "invalid parameters, use remap(tile,index,flip=0,rotate=0,frames=1,ticks=1) or remap()");
+
+    tic_mem* memory = (tic_mem*)getMRubyMachine(mrb);
+
+    return mrb_bool_value(tic_api_remap(memory, tile, index, flip, rotate, frames, ticks));
+}
+
 static mrb_value mrb_music(mrb_state* mrb, mrb_value self)
 {
     mrb_int track = 0;
@@ -10,6 +10,8 @@ struct CachedNames{
     pkpy_CName _tic_core;
     pkpy_CName len;
     pkpy_CName __getitem__;
+    pkpy_CName list;
+    pkpy_CName append;
     pkpy_CName TIC;
     pkpy_CName BOOT;
     pkpy_CName SCN;
@@ -266,6 +268,24 @@ static int py_clip(pkpy_vm* vm)
     return 0;
 }
 
+static int py_canvas(pkpy_vm* vm)
+{
+    tic_mem* tic;
+    int index;
+    int w;
+    int h;
+
+    pkpy_to_int(vm, 0, &index);
+    pkpy_to_int(vm, 1, &w);
+    pkpy_to_int(vm, 2, &h);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_bool(vm, tic_api_canvas(tic, index, w, h));
+    return 1;
+}
+
 static int py_exit(pkpy_vm* vm) 
 {
     tic_mem* tic;
@@ -290,7 +310,7 @@ static int py_fget(pkpy_vm* vm)
     if(pkpy_check_error(vm))
         return 0;
 
-    bool set = tic_api_fget(tic, sprite_id, (u8)flag);
+    bool set = tic_api_fget(tic, sprite_id, flag);
     pkpy_push_bool(vm, set);
     return 1;
 }
@@ -309,7 +329,7 @@ static int py_fset(pkpy_vm* vm)
     if(pkpy_check_error(vm))
         return 0;
 
-    tic_api_fset(tic, sprite_id, (u8)flag, set_to);
+    tic_api_fset(tic, sprite_id, flag, set_to);
     return 0;
 }
 
@@ -456,7 +476,7 @@ static int py_map(pkpy_vm* vm)
     int scale;
     bool used_remap;
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
 
     pkpy_to_int(vm, 0, &x);
     pkpy_to_int(vm, 1, &y);
@@ -480,6 +500,30 @@ static int py_map(pkpy_vm* vm)
     return 0;
 }
 
+static int py_remap(pkpy_vm* vm)
+{
+    tic_mem* tic;
+    int tile;
+    int index;
+    int flip;
+    int rotate;
+    int frames;
+    int ticks;
+
+    pkpy_to_int(vm, 0, &tile);
+    pkpy_to_int(vm, 1, &index);
+    pkpy_to_int(vm, 2, &flip);
+    pkpy_to_int(vm, 3, &rotate);
+    pkpy_to_int(vm, 4, &frames);
+    pkpy_to_int(vm, 5, &ticks);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_bool(vm, tic_api_remap(tic, tile, index, flip, rotate, frames, ticks));
+    return 1;
+}
+
 static int py_memcpy(pkpy_vm* vm) {
     
     tic_mem* tic;
@@ -555,6 +599,165 @@ static int py_mset(pkpy_vm* vm) {
     return 0;
 }
 
+static int py_mflag(pkpy_vm* vm) {
+
+    tic_mem* tic;
+    int x;
+    int y;
+    int w;
+    int h;
+    int flag;
+
+    pkpy_to_int(vm, 0, &x);
+    pkpy_to_int(vm, 1, &y);
+    pkpy_to_int(vm, 2, &w);
+    pkpy_to_int(vm, 3, &h);
+    pkpy_to_int(vm, 4, &flag);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_bool(vm, tic_api_mflag(tic, x, y, w, h, flag));
+    return 1;
+}
+
+static int py_mray(pkpy_vm* vm) {
+
+    tic_mem* tic;
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+    int flag;
+
+    pkpy_to_float(vm, 0, &x0);
+    pkpy_to_float(vm, 1, &y0);
+    pkpy_to_float(vm, 2, &x1);
+    pkpy_to_float(vm, 3, &y1);
+    pkpy_to_int(vm, 4, &flag);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_int(vm, tic_api_mray(tic, x0, y0, x1, y1, flag));
+    return 1;
+}
+
+static int py_mrect(pkpy_vm* vm) {
+
+    tic_mem* tic;
+    int x;
+    int y;
+    int w;
+    int h;
+
+    pkpy_to_int(vm, 0, &x);
+    pkpy_to_int(vm, 1, &y);
+    pkpy_to_int(vm, 2, &w);
+    pkpy_to_int(vm, 3, &h);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+    u8* tiles = malloc(count + 1);
+
+    if(!tiles)
+    {
+        pkpy_error(vm, "tic80-panic!", pkpy_string("out of memory\n"));
+        return 0;
+    }
+
+    tic_api_mrect(tic, x, y, w, h, tiles);
+
+    pkpy_getglobal(vm, N.list);
+    pkpy_push_null(vm);
+    pkpy_vectorcall(vm, 0);
+
+    for(s32 i = 0; i < count; i++)
+    {
+        pkpy_dup(vm, -1); //get the list
+        pkpy_get_unbound_method(vm, N.append);
+        pkpy_push_int(vm, tiles[i]);
+        pkpy_vectorcall(vm, 1);
+        pkpy_pop_top(vm);
+    }
+
+    free(tiles);
+    return 1;
+}
+
+static int py_path(pkpy_vm* vm) {
+
+    tic_mem* tic;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+    int flag;
+
+    pkpy_to_int(vm, 0, &x0);
+    pkpy_to_int(vm, 1, &y0);
+    pkpy_to_int(vm, 2, &x1);
+    pkpy_to_int(vm, 3, &y1);
+    pkpy_to_int(vm, 4, &flag);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    const u16* cells;
+    s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+    pkpy_getglobal(vm, N.list);
+    pkpy_push_null(vm);
+    pkpy_vectorcall(vm, 0);
+
+    for(s32 i = 0; i < count; i++)
+    {
+        pkpy_dup(vm, -1); //get the list
+        pkpy_get_unbound_method(vm, N.append);
+        pkpy_push_int(vm, cells[i]);
+        pkpy_vectorcall(vm, 1);
+        pkpy_pop_top(vm);
+    }
+
+    return 1;
+}
+
+static int py_flow(pkpy_vm* vm) {
+
+    tic_mem* tic;
+    int x;
+    int y;
+    int flag;
+
+    pkpy_to_int(vm, 0, &x);
+    pkpy_to_int(vm, 1, &y);
+    pkpy_to_int(vm, 2, &flag);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_int(vm, tic_api_flow(tic, x, y, flag));
+    return 1;
+}
+
+static int py_flowstep(pkpy_vm* vm) {
+
+    tic_mem* tic;
+    int x;
+    int y;
+
+    pkpy_to_int(vm, 0, &x);
+    pkpy_to_int(vm, 1, &y);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_int(vm, tic_api_flowstep(tic, x, y));
+    return 1;
+}
+
 
 static int py_mouse(pkpy_vm* vm) {
     
@@ -957,7 +1160,7 @@ static int py_spr(pkpy_vm* vm)
     int w;
     int h;
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
 
     pkpy_to_int(vm, 0, &spr_id);
     pkpy_to_int(vm, 1, &x);
@@ -1109,7 +1312,7 @@ static int py_ttri(pkpy_vm* vm)
     double z2;
     double z3;
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
 
     pkpy_to_float(vm, 0, &x1);
     pkpy_to_float(vm, 1, &y1);
@@ -1171,7 +1374,71 @@ static int py_vbank(pkpy_vm* vm) {
     return 1;
 }
 
+static int py_batch(pkpy_vm* vm)
+{
+    tic_mem* tic;
+    int count;
+
+    pkpy_getglobal(vm, N.len);
+    pkpy_push_null(vm);
+    pkpy_dup(vm, 0); //get the list
+    pkpy_vectorcall(vm, 1);
+    pkpy_to_int(vm, -1, &count);
+    pkpy_pop_top(vm);
+
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    float* commands = count > 0 ? malloc(count * sizeof *commands) : NULL;
+    int done = 0;
+
+    if(commands)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            double value;
+            pkpy_dup(vm, 0); //get the list
+            pkpy_get_unbound_method(vm, N.__getitem__);
+            pkpy_push_int(vm, i);
+            pkpy_vectorcall(vm, 1);
+            pkpy_to_float(vm, -1, &value);
+            commands[i] = value;
+            pkpy_pop_top(vm);
+        }
+
+        if(!pkpy_check_error(vm))
+            done = tic_api_batch(tic, commands, count);
+
+        free(commands);
+    }
+
+    pkpy_push_int(vm, done);
+    return 1;
+}
+
+static int py_raster(pkpy_vm* vm)
+{
+    tic_mem* tic;
+    int row;
+    int address;
+    int value;
+
+    pkpy_to_int(vm, 0, &row);
+    pkpy_to_int(vm, 1, &address);
+    pkpy_to_int(vm, 2, &value);
+    get_core(vm, (tic_core**) &tic);
+    if(pkpy_check_error(vm))
+        return 0;
+
+    pkpy_push_bool(vm, tic_api_raster(tic, row, address, value));
+    return 1;
+}
+
 static bool setup_c_bindings(pkpy_vm* vm) {
+    pkpy_push_function(vm, "batch(commands: list) -> int", py_batch);
+    pkpy_setglobal_2(vm, "batch");
+
     pkpy_push_function(vm, "btn(id: int) -> bool", py_btn);
     pkpy_setglobal_2(vm, "btn");
     pkpy_push_function(vm, "btnp(id: int, hold=-1, period=-1) -> bool", py_btnp);
@@ -1185,6 +1452,9 @@ static bool setup_c_bindings(pkpy_vm* vm) {
     pkpy_push_function(vm, "clip(x: int, y: int, width: int, height: int)", py_clip);
     pkpy_setglobal_2(vm, "clip");
 
+    pkpy_push_function(vm, "canvas(id=-1, w=1, h=1) -> bool", py_canvas);
+    pkpy_setglobal_2(vm, "canvas");
+
     pkpy_push_function(vm, "cls(color=0)", py_cls);
     pkpy_setglobal_2(vm, "cls");
 
@@ -1215,6 +1485,9 @@ static bool setup_c_bindings(pkpy_vm* vm) {
     pkpy_push_function(vm, "map(x=0, y=0, w=30, h=17, sx=0, sy=0, colorkey=-1, scale=1, remap=None)", py_map);
     pkpy_setglobal_2(vm, "map");
 
+    pkpy_push_function(vm, "remap(tile=-1, index=0, flip=0, rotate=0, frames=1, ticks=1) -> bool", py_remap);
+    pkpy_setglobal_2(vm, "remap");
+
     pkpy_push_function(vm, "memcpy(dest: int, source: int, size: int)", py_memcpy);
     pkpy_setglobal_2(vm, "memcpy");
     pkpy_push_function(vm, "memset(dest: int, value: int, size: int)", py_memset);
@@ -1224,6 +1497,19 @@ static bool setup_c_bindings(pkpy_vm* vm) {
     pkpy_setglobal_2(vm, "mget");
     pkpy_push_function(vm, "mset(x: int, y: int, tile_id: int)", py_mset);
     pkpy_setglobal_2(vm, "mset");
+    pkpy_push_function(vm, "mflag(x: int, y: int, w: int, h: int, flag: int) -> bool", py_mflag);
+    pkpy_setglobal_2(vm, "mflag");
+    pkpy_push_function(vm, "mray(x0: float, y0: float, x1: float, y1: float, flag: int) -> int", py_mray);
+    pkpy_setglobal_2(vm, "mray");
+    pkpy_push_function(vm, "mrect(x: int, y: int, w: int, h: int) -> list", py_mrect);
+    pkpy_setglobal_2(vm, "mrect");
+
+    pkpy_push_function(vm, "path(x0: int, y0: int, x1: int, y1: int, flag: int) -> list", py_path);
+    pkpy_setglobal_2(vm, "path");
+    pkpy_push_function(vm, "flow(x: int, y: int, flag: int) -> int", py_flow);
+    pkpy_setglobal_2(vm, "flow");
+    pkpy_push_function(vm, "flowstep(x: int, y: int) -> int", py_flowstep);
+    pkpy_setglobal_2(vm, "flowstep");
 
     pkpy_push_function(vm, "mouse() -> tuple[int, int, bool, bool, bool, int, int]", py_mouse);
     pkpy_setglobal_2(vm, "mouse");
@@ -1258,6 +1544,9 @@ static bool setup_c_bindings(pkpy_vm* vm) {
     pkpy_push_function(vm, "print(text, x=0, y=0, color=15, fixed=False, scale=1, alt=False)", py_print);
     pkpy_setglobal_2(vm, "print");
 
+    pkpy_push_function(vm, "raster(row=-1, addr=0, value=0) -> bool", py_raster);
+    pkpy_setglobal_2(vm, "raster");
+
     pkpy_push_function(vm, "rect(x: int, y: int, w: int, h: int, color: int)", py_rect);
     pkpy_setglobal_2(vm, "rect");
     pkpy_push_function(vm, "rectb(x: int, y: int, w: int, h: int, color: int)", py_rectb);
@@ -1327,6 +1616,8 @@ static bool initPython(tic_mem* tic, const char* code)
     N._tic_core = pkpy_name("_tic_core");
     N.len = pkpy_name("len");
     N.__getitem__ = pkpy_name("__getitem__");
+    N.list = pkpy_name("list");
+    N.append = pkpy_name("append");
     N.TIC = pkpy_name("TIC");
     N.BOOT = pkpy_name("BOOT");
     N.SCN = pkpy_name("SCN");
@@ -150,7 +150,7 @@ s7_pointer scheme_spr(s7_scheme* sc, s7_pointer args)
     const s32 x         = s7_integer(s7_cadr(args));
     const s32 y         = s7_integer(s7_caddr(args));
 
-    static u8 trans_colors[TIC_PALETTE_SIZE];
+    u8 trans_colors[TIC_PALETTE_SIZE] = {0};
     u8 trans_count = 0;
     if (argn > 3)
     {
@@ -316,7 +316,7 @@ s7_pointer scheme_map(s7_scheme* sc, s7_pointer args)
 
     const int argn = s7_list_length(sc, args);
 
-    static u8 trans_colors[TIC_PALETTE_SIZE];
+    u8 trans_colors[TIC_PALETTE_SIZE] = {0};
     u8 trans_count = 0;
     if (argn > 6) {
         s7_pointer colorkey = s7_list_ref(sc, args, 6);
@@ -336,6 +336,20 @@ s7_pointer scheme_map(s7_scheme* sc, s7_pointer args)
     tic_api_map(tic, x, y, w, h, sx, sy, trans_colors, trans_count, scale, remap, &data);
     return s7_nil(sc);
 }
+s7_pointer scheme_remap(s7_scheme* sc, s7_pointer args)
+{
+    // remap(tile index flip=0 rotate=0 frames=1 ticks=1) -> ok
+    // remap()
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const int argn = s7_list_length(sc, args);
+    const s32 tile = argn > 0 ? s7_integer(s7_list_ref(sc, args, 0)) : -1;
+    const s32 index = argn > 1 ? s7_integer(s7_list_ref(sc, args, 1)) : 0;
+    const u8 flip = argn > 2 ? s7_integer(s7_list_ref(sc, args, 2)) : 0;
+    const u8 rotate = argn > 3 ? s7_integer(s7_list_ref(sc, args, 3)) : 0;
+    const s32 frames = argn > 4 ? s7_integer(s7_list_ref(sc, args, 4)) : 1;
+    const s32 ticks = argn > 5 ? s7_integer(s7_list_ref(sc, args, 5)) : 1;
+    return s7_make_boolean(sc, tic_api_remap(tic, tile, index, flip, rotate, frames, ticks));
+}
 s7_pointer scheme_mget(s7_scheme* sc, s7_pointer args)
 {
     // mget(x y) -> tile_id
@@ -354,6 +368,87 @@ s7_pointer scheme_mset(s7_scheme* sc, s7_pointer args)
     tic_api_mset(tic, x, y, tile_id);
     return s7_nil(sc);
 }
+s7_pointer scheme_mflag(s7_scheme* sc, s7_pointer args)
+{
+    // mflag(x y w h flag) -> bool
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const s32 x = s7_integer(s7_list_ref(sc, args, 0));
+    const s32 y = s7_integer(s7_list_ref(sc, args, 1));
+    const s32 w = s7_integer(s7_list_ref(sc, args, 2));
+    const s32 h = s7_integer(s7_list_ref(sc, args, 3));
+    const s32 flag = s7_integer(s7_list_ref(sc, args, 4));
+    return s7_make_boolean(sc, tic_api_mflag(tic, x, y, w, h, flag));
+}
+s7_pointer scheme_mray(s7_scheme* sc, s7_pointer args)
+{
+    // mray(x0 y0 x1 y1 flag) -> cell
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const float x0 = s7_number_to_real(sc, s7_list_ref(sc, args, 0));
+    const float y0 = s7_number_to_real(sc, s7_list_ref(sc, args, 1));
+    const float x1 = s7_number_to_real(sc, s7_list_ref(sc, args, 2));
+    const float y1 = s7_number_to_real(sc, s7_list_ref(sc, args, 3));
+    const s32 flag = s7_integer(s7_list_ref(sc, args, 4));
+    return s7_make_integer(sc, tic_api_mray(tic, x0, y0, x1, y1, flag));
+}
+s7_pointer scheme_mrect(s7_scheme* sc, s7_pointer args)
+{
+    // mrect(x y w h) -> tile_ids
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const s32 x = s7_integer(s7_list_ref(sc, args, 0));
+    const s32 y = s7_integer(s7_list_ref(sc, args, 1));
+    const s32 w = s7_integer(s7_list_ref(sc, args, 2));
+    const s32 h = s7_integer(s7_list_ref(sc, args, 3));
+
+    const s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+    u8* tiles = malloc(count + 1);
+    if (!tiles)
+        return s7_error(sc, s7_make_symbol(sc, "out-of-memory"), s7_list(sc, 1, s7_make_string(sc, "mrect")));
+
+    tic_api_mrect(tic, x, y, w, h, tiles);
+
+    s7_pointer result = s7_nil(sc);
+    for (s32 i=count-1; i>=0; --i)
+        result = s7_cons(sc, s7_make_integer(sc, tiles[i]), result);
+
+    free(tiles);
+    return result;
+}
+s7_pointer scheme_path(s7_scheme* sc, s7_pointer args)
+{
+    // path(x0 y0 x1 y1 flag) -> cells
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const s32 x0 = s7_integer(s7_list_ref(sc, args, 0));
+    const s32 y0 = s7_integer(s7_list_ref(sc, args, 1));
+    const s32 x1 = s7_integer(s7_list_ref(sc, args, 2));
+    const s32 y1 = s7_integer(s7_list_ref(sc, args, 3));
+    const s32 flag = s7_integer(s7_list_ref(sc, args, 4));
+
+    const u16* cells;
+    const s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+    s7_pointer result = s7_nil(sc);
+    for (s32 i=count-1; i>=0; --i)
+        result = s7_cons(sc, s7_make_integer(sc, cells[i]), result);
+
+    return result;
+}
+s7_pointer scheme_flow(s7_scheme* sc, s7_pointer args)
+{
+    // flow(x y flag) -> count
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const s32 x = s7_integer(s7_car(args));
+    const s32 y = s7_integer(s7_cadr(args));
+    const s32 flag = s7_integer(s7_caddr(args));
+    return s7_make_integer(sc, tic_api_flow(tic, x, y, flag));
+}
+s7_pointer scheme_flowstep(s7_scheme* sc, s7_pointer args)
+{
+    // flowstep(x y) -> cell
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const s32 x = s7_integer(s7_car(args));
+    const s32 y = s7_integer(s7_cadr(args));
+    return s7_make_integer(sc, tic_api_flowstep(tic, x, y));
+}
 s7_pointer scheme_peek(s7_scheme* sc, s7_pointer args)
 {
     // peek(addr bits=8) -> value
@@ -495,7 +590,7 @@ s7_pointer scheme_font(s7_scheme* sc, s7_pointer args)
     const s32 x = s7_integer(s7_cadr(args));
     const s32 y = s7_integer(s7_caddr(args));
 
-    static u8 trans_colors[TIC_PALETTE_SIZE];
+    u8 trans_colors[TIC_PALETTE_SIZE] = {0};
     u8 trans_count = 0;
     s7_pointer colorkey = s7_cadddr(args);
     parseTransparentColorsArg(sc, colorkey, trans_colors, &trans_count);
@@ -620,7 +715,7 @@ s7_pointer scheme_ttri(s7_scheme* sc, s7_pointer args)
     const int argn = s7_list_length(sc, args);
     const tic_texture_src texsrc = (tic_texture_src)(argn > 12 ? s7_integer(s7_list_ref(sc, args, 12)) : 0);
     
-    static u8 trans_colors[TIC_PALETTE_SIZE];
+    u8 trans_colors[TIC_PALETTE_SIZE] = {0};
     u8 trans_count = 0;
 
     if (argn > 13)
@@ -654,6 +749,17 @@ s7_pointer scheme_clip(s7_scheme* sc, s7_pointer args)
     }
     return s7_nil(sc);
 }
+s7_pointer scheme_canvas(s7_scheme* sc, s7_pointer args)
+{
+    // canvas(id w=1 h=1) -> ok
+    // canvas()
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const int argn = s7_list_length(sc, args);
+    const s32 index = argn > 0 ? s7_integer(s7_car(args)) : -1;
+    const s32 w = argn > 1 ? s7_integer(s7_cadr(args)) : 1;
+    const s32 h = argn > 2 ? s7_integer(s7_caddr(args)) : 1;
+    return s7_make_boolean(sc, tic_api_canvas(tic, index, w, h));
+}
 s7_pointer scheme_music(s7_scheme* sc, s7_pointer args)
 {
     // music(track=-1 frame=-1 row=-1 loop=true sustain=false tempo=-1 speed=-1)
@@ -724,7 +830,7 @@ s7_pointer scheme_fget(s7_scheme* sc, s7_pointer args)
     // fget(sprite_id flag) -> bool
     tic_mem* tic = (tic_mem*)getSchemeCore(sc);
     const s32 sprite_id = s7_integer(s7_car(args));
-    const u8 flag = s7_integer(s7_cadr(args));
+    const s32 flag = s7_integer(s7_cadr(args));
     return s7_make_boolean(sc, tic_api_fget(tic, sprite_id, flag));
 }
 s7_pointer scheme_fset(s7_scheme* sc, s7_pointer args)
@@ -732,11 +838,54 @@ s7_pointer scheme_fset(s7_scheme* sc, s7_pointer args)
     // fset(sprite_id flag bool)
     tic_mem* tic = (tic_mem*)getSchemeCore(sc);
     const s32 sprite_id = s7_integer(s7_car(args));
-    const u8 flag = s7_integer(s7_cadr(args));
+    const s32 flag = s7_integer(s7_cadr(args));
     const bool val = s7_boolean(sc, s7_caddr(args));
     tic_api_fset(tic, sprite_id, flag, val);
     return s7_nil(sc); 
 }
+s7_pointer scheme_batch(s7_scheme* sc, s7_pointer args)
+{
+    // batch(commands) -> count
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    s7_pointer list = s7_car(args);
+
+    const bool vector = s7_is_vector(list);
+    const s32 count = vector ? s7_vector_length(list) : s7_is_list(sc, list) ? s7_list_length(sc, list) : 0;
+    float* commands = count > 0 ? malloc(count * sizeof *commands) : NULL;
+    s32 done = 0;
+
+    if (commands)
+    {
+        for (s32 i=0; i<count; ++i)
+        {
+            s7_pointer c = vector ? s7_vector_ref(sc, list, i) : s7_car(list);
+            commands[i] = s7_is_real(c) ? s7_number_to_real(sc, c) : 0;
+            if (!vector) list = s7_cdr(list);
+        }
+
+        done = tic_api_batch(tic, commands, count);
+        free(commands);
+    }
+
+    return s7_make_integer(sc, done);
+}
+s7_pointer scheme_raster(s7_scheme* sc, s7_pointer args)
+{
+    // raster(row addr value) -> ok
+    // raster()
+    tic_mem* tic = (tic_mem*)getSchemeCore(sc);
+    const int argn = s7_list_length(sc, args);
+
+    if (argn == 0)
+        return s7_make_boolean(sc, tic_api_raster(tic, -1, 0, 0));
+    else if (argn < 3)
+        return s7_make_boolean(sc, false);
+
+    const s32 row = s7_integer(s7_list_ref(sc, args, 0));
+    const s32 address = s7_integer(s7_list_ref(sc, args, 1));
+    const s32 value = s7_integer(s7_list_ref(sc, args, 2));
+    return s7_make_boolean(sc, tic_api_raster(tic, row, address, value));
+}
 
 static void initAPI(tic_core* core)
 {
@@ -481,7 +481,7 @@ static SQInteger squirrel_ttri(HSQUIRRELVM vm)
             pt[i] = getSquirrelFloat(vm, i + 2);
 
         tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
-        static u8 colors[TIC_PALETTE_SIZE];
+        u8 colors[TIC_PALETTE_SIZE] = {0};
         s32 count = 0;
         tic_texture_src src = tic_tiles_texture;
 
@@ -568,6 +568,30 @@ static SQInteger squirrel_clip(HSQUIRRELVM vm)
     return 0;
 }
 
+static SQInteger squirrel_canvas(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+    if(top == 1)
+    {
+        sq_pushbool(vm, tic_api_canvas(tic, -1, 0, 0) ? SQTrue : SQFalse);
+        return 1;
+    }
+    else if(top <= 4)
+    {
+        s32 index = getSquirrelNumber(vm, 2);
+        s32 w = top >= 3 ? getSquirrelNumber(vm, 3) : 1;
+        s32 h = top >= 4 ? getSquirrelNumber(vm, 4) : 1;
+
+        sq_pushbool(vm, tic_api_canvas(tic, index, w, h) ? SQTrue : SQFalse);
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid parameters, use canvas(id,w=1,h=1) or canvas()\n");
+}
+
 static SQInteger squirrel_btnp(HSQUIRRELVM vm)
 {
     tic_core* core = getSquirrelCore(vm);
@@ -637,7 +661,7 @@ static SQInteger squirrel_spr(HSQUIRRELVM vm)
     s32 scale = 1;
     tic_flip flip = tic_no_flip;
     tic_rotate rotate = tic_no_rotate;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     if(top >= 2) 
@@ -746,6 +770,151 @@ static SQInteger squirrel_mset(HSQUIRRELVM vm)
     return 0;
 }
 
+static SQInteger squirrel_mflag(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 6)
+    {
+        s32 x = getSquirrelNumber(vm, 2);
+        s32 y = getSquirrelNumber(vm, 3);
+        s32 w = getSquirrelNumber(vm, 4);
+        s32 h = getSquirrelNumber(vm, 5);
+        s32 flag = getSquirrelNumber(vm, 6);
+
+        tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+        sq_pushbool(vm, tic_api_mflag(tic, x, y, w, h, flag) ? SQTrue : SQFalse);
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid params, mflag(x,y,w,h,flag)\n");
+}
+
+static SQInteger squirrel_mray(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 6)
+    {
+        float x0 = getSquirrelFloat(vm, 2);
+        float y0 = getSquirrelFloat(vm, 3);
+        float x1 = getSquirrelFloat(vm, 4);
+        float y1 = getSquirrelFloat(vm, 5);
+        s32 flag = getSquirrelNumber(vm, 6);
+
+        tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+        sq_pushinteger(vm, tic_api_mray(tic, x0, y0, x1, y1, flag));
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid params, mray(x0,y0,x1,y1,flag)\n");
+}
+
+static SQInteger squirrel_mrect(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 5)
+    {
+        s32 x = getSquirrelNumber(vm, 2);
+        s32 y = getSquirrelNumber(vm, 3);
+        s32 w = getSquirrelNumber(vm, 4);
+        s32 h = getSquirrelNumber(vm, 5);
+
+        tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+        s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+        u8* tiles = malloc(count + 1);
+
+        if(!tiles)
+            return sq_throwerror(vm, "out of memory\n");
+
+        tic_api_mrect(tic, x, y, w, h, tiles);
+        sq_newarray(vm, 0);
+
+        for(s32 i = 0; i < count; i++)
+        {
+            sq_pushinteger(vm, tiles[i]);
+            sq_arrayappend(vm, -2);
+        }
+
+        free(tiles);
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid params, mrect(x,y,w,h)\n");
+}
+
+static SQInteger squirrel_path(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 6)
+    {
+        s32 x0 = getSquirrelNumber(vm, 2);
+        s32 y0 = getSquirrelNumber(vm, 3);
+        s32 x1 = getSquirrelNumber(vm, 4);
+        s32 y1 = getSquirrelNumber(vm, 5);
+        s32 flag = getSquirrelNumber(vm, 6);
+
+        tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+        const u16* cells;
+        s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+        sq_newarray(vm, 0);
+
+        for(s32 i = 0; i < count; i++)
+        {
+            sq_pushinteger(vm, cells[i]);
+            sq_arrayappend(vm, -2);
+        }
+
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid params, path(x0,y0,x1,y1,flag)\n");
+}
+
+static SQInteger squirrel_flow(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 4)
+    {
+        s32 x = getSquirrelNumber(vm, 2);
+        s32 y = getSquirrelNumber(vm, 3);
+        s32 flag = getSquirrelNumber(vm, 4);
+
+        tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+        sq_pushinteger(vm, tic_api_flow(tic, x, y, flag));
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid params, flow(x,y,flag)\n");
+}
+
+static SQInteger squirrel_flowstep(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 3)
+    {
+        s32 x = getSquirrelNumber(vm, 2);
+        s32 y = getSquirrelNumber(vm, 3);
+
+        tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+        sq_pushinteger(vm, tic_api_flowstep(tic, x, y));
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid params, flowstep(x,y)\n");
+}
+
 typedef struct
 {
     HSQUIRRELVM vm;
@@ -800,7 +969,7 @@ static SQInteger squirrel_map(HSQUIRRELVM vm)
     s32 sx = 0;
     s32 sy = 0;
     s32 scale = 1;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     SQInteger top = sq_gettop(vm);
@@ -884,6 +1053,33 @@ static SQInteger squirrel_map(HSQUIRRELVM vm)
     return 0;
 }
 
+static SQInteger squirrel_remap(HSQUIRRELVM vm)
+{
+    SQInteger top = sq_gettop(vm);
+
+    tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+    if(top == 1)
+    {
+        sq_pushbool(vm, tic_api_remap(tic, -1, 0, 0, 0, 1, 1) ? SQTrue : SQFalse);
+        return 1;
+    }
+    else if(top >= 3 && top <= 7)
+    {
+        s32 tile = getSquirrelNumber(vm, 2);
+        s32 index = getSquirrelNumber(vm, 3);
+        u8 flip = top >= 4 ? getSquirrelNumber(vm, 4) : 0;
+        u8 rotate = top >= 5 ? getSquirrelNumber(vm, 5) : 0;
+        s32 frames = top >= 6 ? getSquirrelNumber(vm, 6) : 1;
+        s32 ticks = top >= 7 ? getSquirrelNumber(vm, 7) : 1;
+
+        sq_pushbool(vm, tic_api_remap(tic, tile, index, flip, rotate, frames, ticks) ? SQTrue : SQFalse);
+        return 1;
+    }
+
+    return sq_throwerror(vm, "invalid parameters, use remap(tile,index,flip=0,rotate=0,frames=1,ticks=1) or remap()\n");
+}
+
 static SQInteger squirrel_music(HSQUIRRELVM vm)
 {
     SQInteger top = sq_gettop(vm);
@@ -1467,7 +1663,7 @@ static SQInteger squirrel_fget(HSQUIRRELVM vm)
 
         if(top >= 3)
         {
-            u32 flag = getSquirrelNumber(vm, 3);
+            s32 flag = getSquirrelNumber(vm, 3);
             sq_pushbool(vm, tic_api_fget(tic, index, flag));
             return 1;
         }
@@ -1490,7 +1686,7 @@ static SQInteger squirrel_fset(HSQUIRRELVM vm)
 
         if(top >= 3)
         {
-            u32 flag = getSquirrelNumber(vm, 3);
+            s32 flag = getSquirrelNumber(vm, 3);
 
             if(top >= 4)
             {
@@ -1508,6 +1704,67 @@ static SQInteger squirrel_fset(HSQUIRRELVM vm)
     return 0;
 }
 
+static SQInteger squirrel_batch(HSQUIRRELVM vm)
+{
+    tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 2 && OT_ARRAY == sq_gettype(vm, 2))
+    {
+        s32 count = (s32)sq_getsize(vm, 2);
+        float* commands = count ? malloc(count * sizeof *commands) : NULL;
+        s32 done = 0;
+
+        if(commands)
+        {
+            for(s32 i = 0; i < count; i++)
+            {
+                sq_pushinteger(vm, (SQInteger)i);
+                sq_rawget(vm, 2);
+                commands[i] = getSquirrelFloat(vm, -1);
+                sq_poptop(vm);
+            }
+
+            done = tic_api_batch(tic, commands, count);
+            free(commands);
+        }
+
+        sq_pushinteger(vm, done);
+        return 1;
+    }
+
+    sq_throwerror(vm, "invalid params, batch(commands)\n");
+
+    return 0;
+}
+
+static SQInteger squirrel_raster(HSQUIRRELVM vm)
+{
+    tic_mem* tic = (tic_mem*)getSquirrelCore(vm);
+
+    SQInteger top = sq_gettop(vm);
+
+    if(top == 1)
+    {
+        sq_pushbool(vm, tic_api_raster(tic, -1, 0, 0) ? SQTrue : SQFalse);
+        return 1;
+    }
+    else if(top >= 4)
+    {
+        s32 row = getSquirrelNumber(vm, 2);
+        s32 address = getSquirrelNumber(vm, 3);
+        s32 value = getSquirrelNumber(vm, 4);
+
+        sq_pushbool(vm, tic_api_raster(tic, row, address, value) ? SQTrue : SQFalse);
+        return 1;
+    }
+
+    sq_throwerror(vm, "invalid params, raster(row,addr,value)\n");
+
+    return 0;
+}
+
 static SQInteger squirrel_dofile(HSQUIRRELVM vm)
 {
     return sq_throwerror(vm, "unknown method: \"dofile\"\n");
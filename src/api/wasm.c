@@ -415,7 +415,7 @@ m3ApiRawFunction(wasmtic_fget)
     m3ApiReturnType  (bool)
 
     m3ApiGetArg      (int32_t, sprite_index);
-    m3ApiGetArg      (int8_t, flag);
+    m3ApiGetArg      (int32_t, flag);
     
     tic_mem* tic = (tic_mem*)getWasmCore(runtime);
 
@@ -427,7 +427,7 @@ m3ApiRawFunction(wasmtic_fget)
 m3ApiRawFunction(wasmtic_fset)
 {
     m3ApiGetArg      (int32_t, sprite_index);
-    m3ApiGetArg      (int8_t, flag);
+    m3ApiGetArg      (int32_t, flag);
     m3ApiGetArg      (bool, value);
 
     tic_mem* tic = (tic_mem*)getWasmCore(runtime);
@@ -437,6 +437,43 @@ m3ApiRawFunction(wasmtic_fset)
     m3ApiSuccess();
 }
 
+// the commands are f32 values in the module memory, drawn without copying
+m3ApiRawFunction(wasmtic_batch)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArgMem   (const float*, commands)
+    m3ApiGetArg      (int32_t, count)
+
+    if (commands == NULL || count < 0) {
+        m3ApiReturn(0);
+    }
+
+    m3ApiCheckMem(commands, count * sizeof(float));
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    m3ApiReturn(tic_api_batch(tic, commands, count));
+
+    m3ApiSuccess();
+}
+
+// a negative row clears the table
+m3ApiRawFunction(wasmtic_raster)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, row)
+    m3ApiGetArg      (int32_t, address)
+    m3ApiGetArg      (int32_t, value)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    m3ApiReturn(tic_api_raster(tic, row, address, value));
+
+    m3ApiSuccess();
+}
+
 m3ApiRawFunction(wasmtic_mget)
 {
     m3ApiReturnType  (int32_t)
@@ -464,6 +501,115 @@ m3ApiRawFunction(wasmtic_mset)
     m3ApiSuccess();
 }
 
+m3ApiRawFunction(wasmtic_mflag)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, x)
+    m3ApiGetArg      (int32_t, y)
+    m3ApiGetArg      (int32_t, w)
+    m3ApiGetArg      (int32_t, h)
+    m3ApiGetArg      (int32_t, flag)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    m3ApiReturn(tic_api_mflag(tic, x, y, w, h, flag));
+
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(wasmtic_mray)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (float, x0)
+    m3ApiGetArg      (float, y0)
+    m3ApiGetArg      (float, x1)
+    m3ApiGetArg      (float, y1)
+    m3ApiGetArg      (int32_t, flag)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    m3ApiReturn(tic_api_mray(tic, x0, y0, x1, y1, flag));
+
+    m3ApiSuccess();
+}
+
+// the tile ids are written to the module memory
+m3ApiRawFunction(wasmtic_mrect)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, x)
+    m3ApiGetArg      (int32_t, y)
+    m3ApiGetArg      (int32_t, w)
+    m3ApiGetArg      (int32_t, h)
+    m3ApiGetArgMem   (uint8_t*, tiles)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+
+    m3ApiCheckMem(tiles, count);
+
+    m3ApiReturn(tic_api_mrect(tic, x, y, w, h, tiles));
+
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(wasmtic_path)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, x0)
+    m3ApiGetArg      (int32_t, y0)
+    m3ApiGetArg      (int32_t, x1)
+    m3ApiGetArg      (int32_t, y1)
+    m3ApiGetArg      (int32_t, flag)
+    m3ApiGetArgMem   (uint16_t*, out)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    const u16* cells;
+    s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+    m3ApiCheckMem(out, count * sizeof(uint16_t));
+    memcpy(out, cells, count * sizeof(uint16_t));
+
+    m3ApiReturn(count);
+
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(wasmtic_flow)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, x)
+    m3ApiGetArg      (int32_t, y)
+    m3ApiGetArg      (int32_t, flag)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    m3ApiReturn(tic_api_flow(tic, x, y, flag));
+
+    m3ApiSuccess();
+}
+
+m3ApiRawFunction(wasmtic_flowstep)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, x)
+    m3ApiGetArg      (int32_t, y)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    m3ApiReturn(tic_api_flowstep(tic, x, y));
+
+    m3ApiSuccess();
+}
+
 
 m3ApiRawFunction(wasmtic_peek)
 {
@@ -664,6 +810,25 @@ m3ApiRawFunction(wasmtic_clip)
     m3ApiSuccess();
 }
 
+m3ApiRawFunction(wasmtic_canvas)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, index)
+    m3ApiGetArg      (int32_t, w)
+    m3ApiGetArg      (int32_t, h)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    // defaults
+    if (w == -1) { w = 1; }
+    if (h == -1) { h = 1; }
+
+    m3ApiReturn(tic_api_canvas(tic, index, w, h));
+
+    m3ApiSuccess();
+}
+
 m3ApiRawFunction(wasmtic_map)
 {
     m3ApiGetArg      (int32_t, x)
@@ -694,6 +859,30 @@ m3ApiRawFunction(wasmtic_map)
     m3ApiSuccess();
 }
 
+m3ApiRawFunction(wasmtic_remap)
+{
+    m3ApiReturnType  (int32_t)
+
+    m3ApiGetArg      (int32_t, tile)
+    m3ApiGetArg      (int32_t, index)
+    m3ApiGetArg      (int8_t, flip)
+    m3ApiGetArg      (int8_t, rotate)
+    m3ApiGetArg      (int32_t, frames)
+    m3ApiGetArg      (int32_t, ticks)
+
+    tic_mem* tic = (tic_mem*)getWasmCore(runtime);
+
+    // defaults
+    if (flip == -1) { flip = 0; }
+    if (rotate == -1) { rotate = 0; }
+    if (frames == -1) { frames = 1; }
+    if (ticks == -1) { ticks = 1; }
+
+    m3ApiReturn(tic_api_remap(tic, tile, index, flip, rotate, frames, ticks));
+
+    m3ApiSuccess();
+}
+
 m3ApiRawFunction(wasmtic_print)
 {
     m3ApiReturnType  (int32_t)
@@ -914,6 +1103,9 @@ m3ApiRawFunction(wasmtic_vbank)
     tic_mem* tic = (tic_mem*)getWasmCore(runtime);
 
     uint8_t previous_bank = tic_api_vbank(tic, bank);
+
+    // wasm addresses RAM directly
+    tic_core_vbank_sync(tic);
     m3ApiReturn(previous_bank);
 
     m3ApiSuccess();
@@ -959,9 +1151,11 @@ m3ApiRawFunction(wasmtic_mouse)
 M3Result linkTicAPI(IM3Module module)
 {
     M3Result result = m3Err_none;
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "batch",   "i(*i)",         &wasmtic_batch)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "btn",     "i(i)",          &wasmtic_btn)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "btnp",    "i(iii)",        &wasmtic_btnp)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "clip",    "v(iiii)",       &wasmtic_clip)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "canvas",  "i(iii)",        &wasmtic_canvas)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "cls",     "v(i)",          &wasmtic_cls)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "circ",    "v(iiii)",       &wasmtic_circ)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "circb",   "v(iiii)",       &wasmtic_circb)));
@@ -976,10 +1170,17 @@ M3Result linkTicAPI(IM3Module module)
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "line",    "v(ffffi)",      &wasmtic_line)));
     // TODO: needs a lot of help for all the optional arguments
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "map",     "v(iiiiiiiiii)", &wasmtic_map)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "remap",   "i(iiiiii)",     &wasmtic_remap)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "memcpy",  "v(iii)",        &wasmtic_memcpy)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "memset",  "v(iii)",        &wasmtic_memset)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "mget",    "i(ii)",         &wasmtic_mget)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "mset",    "v(iii)",        &wasmtic_mset)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "mflag",   "i(iiiii)",      &wasmtic_mflag)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "mray",    "i(ffffi)",      &wasmtic_mray)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "mrect",   "i(iiii*)",      &wasmtic_mrect)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "path",    "i(iiiii*)",     &wasmtic_path)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "flow",    "i(iii)",        &wasmtic_flow)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "flowstep","i(ii)",         &wasmtic_flowstep)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "mouse",   "v(*)",          &wasmtic_mouse)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "music",   "v(iiiiiii)",    &wasmtic_music)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "pix",     "i(iii)",        &wasmtic_pix)));
@@ -993,6 +1194,7 @@ M3Result linkTicAPI(IM3Module module)
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "poke2",   "v(ii)",         &wasmtic_poke2)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "poke1",   "v(ii)",         &wasmtic_poke1)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "print",   "i(*iiiiii)",    &wasmtic_print)));
+    _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "raster",  "i(iii)",        &wasmtic_raster)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "rect",    "v(iiiii)",      &wasmtic_rect)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "rectb",   "v(iiiii)",      &wasmtic_rectb)));
     _   (SuppressLookupFailure (m3_LinkRawFunction (module, "env", "sfx",     "v(iiiiiiii)",   &wasmtic_sfx)));
@@ -71,9 +71,19 @@ class TIC {\n\
     foreign static map(cell_x, cell_y, cell_w, cell_h, x, y)\n\
     foreign static map(cell_x, cell_y, cell_w, cell_h, x, y, alpha_color)\n\
     foreign static map(cell_x, cell_y, cell_w, cell_h, x, y, alpha_color, scale)\n\
+    foreign static remap()\n\
+    foreign static remap(tile, index)\n\
+    foreign static remap(tile, index, flip, rotate)\n\
+    foreign static remap(tile, index, flip, rotate, frames, ticks)\n\
     foreign static mset(cell_x, cell_y)\n\
     foreign static mset(cell_x, cell_y, index)\n\
     foreign static mget(cell_x, cell_y)\n\
+    foreign static mflag(x, y, w, h, flag)\n\
+    foreign static mray(x0, y0, x1, y1, flag)\n\
+    foreign static mrect(cell_x, cell_y, w, h)\n\
+    foreign static path(x0, y0, x1, y1, flag)\n\
+    foreign static flow(cell_x, cell_y, flag)\n\
+    foreign static flowstep(cell_x, cell_y)\n\
     "
 
 #if defined(BUILD_DEPRECATED)
@@ -103,6 +113,9 @@ class TIC {\n\
     foreign static cls(color)\n\
     foreign static clip()\n\
     foreign static clip(x, y, w, h)\n\
+    foreign static canvas()\n\
+    foreign static canvas(id)\n\
+    foreign static canvas(id, w, h)\n\
     foreign static peek(addr)\n\
     foreign static poke(addr, val)\n\
     foreign static peek(addr, bits)\n\
@@ -149,6 +162,9 @@ class TIC {\n\
     foreign static spr__(id, x, y, alpha_color, scale, flip, rotate)\n\
     foreign static fget(index, flag)\n\
     foreign static fset(index, flag, val)\n\
+    foreign static batch(commands)\n\
+    foreign static raster()\n\
+    foreign static raster(row, addr, value)\n\
     foreign static mgeti__(index)\n\
     static print(v) { TIC.print__(v.toString, 0, 0, 15, false, 1, false) }\n\
     static print(v,x,y) { TIC.print__(v.toString, x, y, 15, false, 1, false) }\n\
@@ -544,7 +560,7 @@ static void wren_spr(WrenVM* vm)
     s32 scale = 1;
     tic_flip flip = tic_no_flip;
     tic_rotate rotate = tic_no_rotate;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     if(top > 1)
@@ -619,7 +635,7 @@ static void wren_spr_internal(WrenVM* vm)
     s32 x = getWrenNumber(vm, 2);
     s32 y = getWrenNumber(vm, 3);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     if(isList(vm, 4))
@@ -664,7 +680,7 @@ static void wren_map(WrenVM* vm)
     s32 sx = 0;
     s32 sy = 0;
     s32 scale = 1;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
 
     s32 top = wrenGetSlotCount(vm);
@@ -724,6 +740,22 @@ static void wren_map(WrenVM* vm)
     tic_api_map(tic, x, y, w, h, sx, sy, colors, count, scale, NULL, NULL);
 }
 
+static void wren_remap(WrenVM* vm)
+{
+    s32 top = wrenGetSlotCount(vm);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    s32 tile = top > 1 ? getWrenNumber(vm, 1) : -1;
+    s32 index = top > 2 ? getWrenNumber(vm, 2) : 0;
+    u8 flip = top > 3 ? getWrenNumber(vm, 3) : 0;
+    u8 rotate = top > 4 ? getWrenNumber(vm, 4) : 0;
+    s32 frames = top > 5 ? getWrenNumber(vm, 5) : 1;
+    s32 ticks = top > 6 ? getWrenNumber(vm, 6) : 1;
+
+    wrenSetSlotBool(vm, 0, tic_api_remap(tic, tile, index, flip, rotate, frames, ticks));
+}
+
 static void wren_mset(WrenVM* vm)
 {
     s32 x = getWrenNumber(vm, 1);
@@ -735,6 +767,106 @@ static void wren_mset(WrenVM* vm)
     tic_api_mset(tic, x, y, value);
 }
 
+static void wren_mflag(WrenVM* vm)
+{
+    s32 x = getWrenNumber(vm, 1);
+    s32 y = getWrenNumber(vm, 2);
+    s32 w = getWrenNumber(vm, 3);
+    s32 h = getWrenNumber(vm, 4);
+    s32 flag = getWrenNumber(vm, 5);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    wrenSetSlotBool(vm, 0, tic_api_mflag(tic, x, y, w, h, flag));
+}
+
+static void wren_mray(WrenVM* vm)
+{
+    float x0 = (float)wrenGetSlotDouble(vm, 1);
+    float y0 = (float)wrenGetSlotDouble(vm, 2);
+    float x1 = (float)wrenGetSlotDouble(vm, 3);
+    float y1 = (float)wrenGetSlotDouble(vm, 4);
+    s32 flag = getWrenNumber(vm, 5);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    wrenSetSlotDouble(vm, 0, tic_api_mray(tic, x0, y0, x1, y1, flag));
+}
+
+static void wren_mrect(WrenVM* vm)
+{
+    s32 x = getWrenNumber(vm, 1);
+    s32 y = getWrenNumber(vm, 2);
+    s32 w = getWrenNumber(vm, 3);
+    s32 h = getWrenNumber(vm, 4);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    s32 count = tic_api_mrect(tic, x, y, w, h, NULL);
+    u8* tiles = malloc(count + 1);
+
+    if(!tiles)
+    {
+        wrenError(vm, "out of memory\n");
+        return;
+    }
+
+    tic_api_mrect(tic, x, y, w, h, tiles);
+
+    wrenSetSlotNewList(vm, 0);
+
+    for(s32 i = 0; i < count; i++)
+    {
+        wrenSetSlotDouble(vm, 1, tiles[i]);
+        wrenInsertInList(vm, 0, -1, 1);
+    }
+
+    free(tiles);
+}
+
+static void wren_path(WrenVM* vm)
+{
+    s32 x0 = getWrenNumber(vm, 1);
+    s32 y0 = getWrenNumber(vm, 2);
+    s32 x1 = getWrenNumber(vm, 3);
+    s32 y1 = getWrenNumber(vm, 4);
+    s32 flag = getWrenNumber(vm, 5);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    const u16* cells;
+    s32 count = tic_api_path(tic, x0, y0, x1, y1, flag, &cells);
+
+    wrenSetSlotNewList(vm, 0);
+
+    for(s32 i = 0; i < count; i++)
+    {
+        wrenSetSlotDouble(vm, 1, cells[i]);
+        wrenInsertInList(vm, 0, -1, 1);
+    }
+}
+
+static void wren_flow(WrenVM* vm)
+{
+    s32 x = getWrenNumber(vm, 1);
+    s32 y = getWrenNumber(vm, 2);
+    s32 flag = getWrenNumber(vm, 3);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    wrenSetSlotDouble(vm, 0, tic_api_flow(tic, x, y, flag));
+}
+
+static void wren_flowstep(WrenVM* vm)
+{
+    s32 x = getWrenNumber(vm, 1);
+    s32 y = getWrenNumber(vm, 2);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    wrenSetSlotDouble(vm, 0, tic_api_flowstep(tic, x, y));
+}
+
 static void wren_mget(WrenVM* vm)
 {
     s32 x = getWrenNumber(vm, 1);
@@ -779,7 +911,7 @@ static void wren_ttri(WrenVM* vm)
     }
 
     tic_mem* tic = (tic_mem*)getWrenCore(vm);
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
     tic_texture_src src = tic_tiles_texture;
 
@@ -841,7 +973,7 @@ static void wren_textri(WrenVM* vm)
 
     tic_core* core = getWrenCore(vm);
     tic_mem* tic = (tic_mem*)core;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE] = {0};
     s32 count = 0;
     tic_texture_src src = tic_tiles_texture;
 
@@ -1060,6 +1192,19 @@ static void wren_clip(WrenVM* vm)
     }
 }
 
+static void wren_canvas(WrenVM* vm)
+{
+    s32 top = wrenGetSlotCount(vm);
+
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+
+    s32 index = top > 1 ? getWrenNumber(vm, 1) : -1;
+    s32 w = top > 2 ? getWrenNumber(vm, 2) : 1;
+    s32 h = top > 3 ? getWrenNumber(vm, 3) : 1;
+
+    wrenSetSlotBool(vm, 0, tic_api_canvas(tic, index, w, h));
+}
+
 static void wren_peek(WrenVM* vm)
 {
     tic_mem* tic = (tic_mem*)getWrenCore(vm);
@@ -1408,7 +1553,7 @@ static void wren_fget(WrenVM* vm)
 
         if(top > 2)
         {
-            u32 flag = getWrenNumber(vm, 2);
+            s32 flag = getWrenNumber(vm, 2);
             wrenSetSlotBool(vm, 0, tic_api_fget(tic, index, flag));
             return;
         }
@@ -1428,7 +1573,7 @@ static void wren_fset(WrenVM* vm)
 
         if(top > 2)
         {
-            u32 flag = getWrenNumber(vm, 2);
+            s32 flag = getWrenNumber(vm, 2);
 
             if(top > 3)
             {
@@ -1442,6 +1587,56 @@ static void wren_fset(WrenVM* vm)
     wrenError(vm, "invalid params, fset(sprite,flag,value)\n");
 }
 
+static void wren_batch(WrenVM* vm)
+{
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+    s32 top = wrenGetSlotCount(vm);
+
+    if(top > 1 && isList(vm, 1))
+    {
+        s32 count = wrenGetListCount(vm, 1);
+        float* commands = count ? malloc(count * sizeof *commands) : NULL;
+        s32 done = 0;
+
+        if(commands)
+        {
+            wrenEnsureSlots(vm, top+1);
+
+            for(s32 i = 0; i < count; i++)
+            {
+                wrenGetListElement(vm, 1, i, top);
+                commands[i] = isNumber(vm, top) ? wrenGetSlotDouble(vm, top) : 0;
+            }
+
+            done = tic_api_batch(tic, commands, count);
+            free(commands);
+        }
+
+        wrenSetSlotDouble(vm, 0, done);
+        return;
+    }
+
+    wrenError(vm, "invalid params, batch(commands)\n");
+}
+
+static void wren_raster(WrenVM* vm)
+{
+    tic_mem* tic = (tic_mem*)getWrenCore(vm);
+    s32 top = wrenGetSlotCount(vm);
+
+    if(top == 1)
+    {
+        wrenSetSlotBool(vm, 0, tic_api_raster(tic, -1, 0, 0));
+        return;
+    }
+
+    s32 row = getWrenNumber(vm, 1);
+    s32 address = getWrenNumber(vm, 2);
+    s32 value = getWrenNumber(vm, 3);
+
+    wrenSetSlotBool(vm, 0, tic_api_raster(tic, row, address, value));
+}
+
 static WrenForeignMethodFn foreignTicMethods(const char* signature)
 {
     if (strcmp(signature, "static TIC.btn()"                    ) == 0) return wren_btn;
@@ -1474,9 +1669,20 @@ static WrenForeignMethodFn foreignTicMethods(const char* signature)
     if (strcmp(signature, "static TIC.map(_,_,_,_,_,_,_)"       ) == 0) return wren_map;
     if (strcmp(signature, "static TIC.map(_,_,_,_,_,_,_,_)"     ) == 0) return wren_map;
 
+    if (strcmp(signature, "static TIC.remap()"                  ) == 0) return wren_remap;
+    if (strcmp(signature, "static TIC.remap(_,_)"               ) == 0) return wren_remap;
+    if (strcmp(signature, "static TIC.remap(_,_,_,_)"           ) == 0) return wren_remap;
+    if (strcmp(signature, "static TIC.remap(_,_,_,_,_,_)"       ) == 0) return wren_remap;
+
     if (strcmp(signature, "static TIC.mset(_,_)"                ) == 0) return wren_mset;
     if (strcmp(signature, "static TIC.mset(_,_,_)"              ) == 0) return wren_mset;
     if (strcmp(signature, "static TIC.mget(_,_)"                ) == 0) return wren_mget;
+    if (strcmp(signature, "static TIC.mflag(_,_,_,_,_)"         ) == 0) return wren_mflag;
+    if (strcmp(signature, "static TIC.mray(_,_,_,_,_)"          ) == 0) return wren_mray;
+    if (strcmp(signature, "static TIC.mrect(_,_,_,_)"           ) == 0) return wren_mrect;
+    if (strcmp(signature, "static TIC.path(_,_,_,_,_)"          ) == 0) return wren_path;
+    if (strcmp(signature, "static TIC.flow(_,_,_)"              ) == 0) return wren_flow;
+    if (strcmp(signature, "static TIC.flowstep(_,_)"            ) == 0) return wren_flowstep;
 
 #if defined(BUILD_DEPRECATED)
     if (strcmp(signature, "static TIC.textri(_,_,_,_,_,_,_,_,_,_,_,_)"      ) == 0) return wren_textri;
@@ -1504,6 +1710,9 @@ static WrenForeignMethodFn foreignTicMethods(const char* signature)
     if (strcmp(signature, "static TIC.cls(_)"                   ) == 0) return wren_cls;
     if (strcmp(signature, "static TIC.clip()"                   ) == 0) return wren_clip;
     if (strcmp(signature, "static TIC.clip(_,_,_,_)"            ) == 0) return wren_clip;
+    if (strcmp(signature, "static TIC.canvas()"                 ) == 0) return wren_canvas;
+    if (strcmp(signature, "static TIC.canvas(_)"                ) == 0) return wren_canvas;
+    if (strcmp(signature, "static TIC.canvas(_,_,_)"            ) == 0) return wren_canvas;
 
     if (strcmp(signature, "static TIC.peek(_)"                  ) == 0) return wren_peek;
     if (strcmp(signature, "static TIC.poke(_,_)"                ) == 0) return wren_poke;
@@ -1547,6 +1756,9 @@ static WrenForeignMethodFn foreignTicMethods(const char* signature)
     if (strcmp(signature, "static TIC.exit()"                   ) == 0) return wren_exit;
     if (strcmp(signature, "static TIC.fget(_,_)"                ) == 0) return wren_fget;
     if (strcmp(signature, "static TIC.fset(_,_,_)"              ) == 0) return wren_fset;
+    if (strcmp(signature, "static TIC.batch(_)"                 ) == 0) return wren_batch;
+    if (strcmp(signature, "static TIC.raster()"                 ) == 0) return wren_raster;
+    if (strcmp(signature, "static TIC.raster(_,_,_)"            ) == 0) return wren_raster;
 
     // internal functions
     if (strcmp(signature, "static TIC.map_width__"              ) == 0) return wren_map_width;
@@ -0,0 +1,460 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <tic80_batch.h>
+#include "api.h"
+#include "cart.h"
+#include "tools.h"
+
+#if !defined(TIC80_BATCH_NO_THREADS)
+#   if defined(_WIN32)
+#       include <windows.h>
+#   else
+#       include <pthread.h>
+#       include <unistd.h>
+#   endif
+#endif
+
+#if defined(TIC80_BATCH_NO_THREADS)
+
+typedef s32 Thread;
+typedef s32 Mutex;
+typedef s32 Cond;
+
+static inline void mutexInit(Mutex* m) {}
+static inline void mutexFree(Mutex* m) {}
+static inline void mutexLock(Mutex* m) {}
+static inline void mutexUnlock(Mutex* m) {}
+static inline void condInit(Cond* c) {}
+static inline void condFree(Cond* c) {}
+static inline void condWait(Cond* c, Mutex* m) {}
+static inline void condBroadcast(Cond* c) {}
+static inline bool threadStart(Thread* t, void(*func)(void*), void* data) {return false;}
+static inline void threadJoin(Thread t) {}
+static inline s32 cpuCount() {return 1;}
+
+#elif defined(_WIN32)
+
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Cond;
+
+typedef struct
+{
+    void(*func)(void*);
+    void* data;
+} ThreadStart;
+
+static DWORD WINAPI threadProc(LPVOID param)
+{
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.func(start.data);
+    return 0;
+}
+
+static inline void mutexInit(Mutex* m) {InitializeCriticalSection(m);}
+static inline void mutexFree(Mutex* m) {DeleteCriticalSection(m);}
+static inline void mutexLock(Mutex* m) {EnterCriticalSection(m);}
+static inline void mutexUnlock(Mutex* m) {LeaveCriticalSection(m);}
+static inline void condInit(Cond* c) {InitializeConditionVariable(c);}
+static inline void condFree(Cond* c) {}
+static inline void condWait(Cond* c, Mutex* m) {SleepConditionVariableCS(c, m, INFINITE);}
+static inline void condBroadcast(Cond* c) {WakeAllConditionVariable(c);}
+
+static inline bool threadStart(Thread* t, void(*func)(void*), void* data)
+{
+    ThreadStart* start = malloc(sizeof(ThreadStart));
+    *start = (ThreadStart){func, data};
+
+    if((*t = CreateThread(NULL, 0, threadProc, start, 0, NULL)))
+        return true;
+
+    free(start);
+    return false;
+}
+
+static inline void threadJoin(Thread t)
+{
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+static inline s32 cpuCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+}
+
+#else
+
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Cond;
+
+typedef struct
+{
+    void(*func)(void*);
+    void* data;
+} ThreadStart;
+
+static void* threadProc(void* param)
+{
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.func(start.data);
+    return NULL;
+}
+
+static inline void mutexInit(Mutex* m) {pthread_mutex_init(m, NULL);}
+static inline void mutexFree(Mutex* m) {pthread_mutex_destroy(m);}
+static inline void mutexLock(Mutex* m) {pthread_mutex_lock(m);}
+static inline void mutexUnlock(Mutex* m) {pthread_mutex_unlock(m);}
+static inline void condInit(Cond* c) {pthread_cond_init(c, NULL);}
+static inline void condFree(Cond* c) {pthread_cond_destroy(c);}
+static inline void condWait(Cond* c, Mutex* m) {pthread_cond_wait(c, m);}
+static inline void condBroadcast(Cond* c) {pthread_cond_broadcast(c);}
+
+static inline bool threadStart(Thread* t, void(*func)(void*), void* data)
+{
+    ThreadStart* start = malloc(sizeof(ThreadStart));
+    *start = (ThreadStart){func, data};
+
+    if(pthread_create(t, NULL, threadProc, start) == 0)
+        return true;
+
+    free(start);
+    return false;
+}
+
+static inline void threadJoin(Thread t)
+{
+    pthread_join(t, NULL);
+}
+
+static inline s32 cpuCount()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+}
+
+#endif
+
+typedef struct
+{
+    tic_mem* mem;
+    tic_tick_data data;
+    u64 frame;
+    u32 status;
+} Instance;
+
+struct tic80_batch
+{
+    Instance* instances;
+    s32 count;
+    tic80_pixel_color_format format;
+
+    struct
+    {
+        tic80_batch_obs type;
+        s32 offset;
+        s32 size;
+    } obs;
+
+    struct
+    {
+        const tic80_input* inputs;
+        u8* obs;
+        u32 flags;
+
+        s32 next;
+        s32 done;
+        u32 generation;
+        bool quit;
+    } job;
+
+    Thread* threads;
+    s32 threadsCount;
+
+    Mutex lock;
+    Cond start;
+    Cond finish;
+};
+
+static void onTrace(void* data, const char* text, u8 color)
+{
+    tic80* tic = &((Instance*)data)->mem->product;
+
+    if(tic->callback.trace)
+        tic->callback.trace(text, color);
+}
+
+static void onError(void* data, const char* info)
+{
+    Instance* instance = data;
+    tic80* tic = &instance->mem->product;
+
+    instance->status |= TIC80_BATCH_ERROR;
+
+    if(tic->callback.error)
+        tic->callback.error(info);
+}
+
+static void onExit(void* data)
+{
+    Instance* instance = data;
+    tic80* tic = &instance->mem->product;
+
+    instance->status |= TIC80_BATCH_EXITED;
+
+    if(tic->callback.exit)
+        tic->callback.exit();
+}
+
+// every instance has its own virtual 60Hz clock driven by the steps
+static u64 counter(void* data)
+{
+    return ((Instance*)data)->frame;
+}
+
+static u64 freq(void* data)
+{
+    return TIC80_FRAMERATE;
+}
+
+static void observe(tic80_batch* batch, s32 index, u8* dst)
+{
+    const tic_mem* mem = batch->instances[index].mem;
+
+    switch(batch->obs.type)
+    {
+    case TIC80_BATCH_OBS_SCREEN:
+        memcpy(dst, mem->product.screen, batch->obs.size);
+        break;
+    case TIC80_BATCH_OBS_RAM:
+        memcpy(dst, mem->ram->data + batch->obs.offset, batch->obs.size);
+        break;
+    default: break;
+    }
+}
+
+static void stepInstance(tic80_batch* batch, s32 index)
+{
+    Instance* instance = &batch->instances[index];
+    tic_mem* mem = instance->mem;
+
+    if(instance->status == TIC80_BATCH_RUNNING)
+    {
+        mem->ram->input = batch->job.inputs[index];
+        tic_core_step(mem, &instance->data, batch->job.flags);
+        instance->frame++;
+    }
+
+    if(batch->job.obs)
+        observe(batch, index, batch->job.obs + (size_t)index * batch->obs.size);
+}
+
+// called with the lock held, instances are handed out one by one
+// so fast workers pick up the slack of slow ones
+static void runJob(tic80_batch* batch)
+{
+    while(batch->job.next < batch->count)
+    {
+        s32 index = batch->job.next++;
+
+        mutexUnlock(&batch->lock);
+        stepInstance(batch, index);
+        mutexLock(&batch->lock);
+
+        if(++batch->job.done == batch->count)
+            condBroadcast(&batch->finish);
+    }
+}
+
+static void worker(void* data)
+{
+    tic80_batch* batch = data;
+    u32 generation = 0;
+
+    mutexLock(&batch->lock);
+
+    for(;;)
+    {
+        while(batch->job.generation == generation && !batch->job.quit)
+            condWait(&batch->start, &batch->lock);
+
+        if(batch->job.quit)
+            break;
+
+        generation = batch->job.generation;
+        runJob(batch);
+    }
+
+    mutexUnlock(&batch->lock);
+}
+
+TIC80_API tic80_batch* tic80_batch_create(s32 count, s32 threads, tic80_pixel_color_format format)
+{
+    if(count <= 0)
+        return NULL;
+
+    tic80_batch* batch = calloc(1, sizeof(tic80_batch));
+
+    batch->count = count;
+    batch->format = format;
+    batch->instances = calloc(count, sizeof(Instance));
+
+    for(s32 i = 0; i < count; i++)
+    {
+        Instance* instance = &batch->instances[i];
+
+        instance->mem = tic_core_create(TIC80_SAMPLERATE, format);
+        instance->data = (tic_tick_data)
+        {
+            .error = onError,
+            .trace = onTrace,
+            .exit = onExit,
+            .data = instance,
+            .start = 0,
+            .counter = counter,
+            .freq = freq
+        };
+    }
+
+    mutexInit(&batch->lock);
+    condInit(&batch->start);
+    condInit(&batch->finish);
+
+    // the calling thread works too, so it's one thread less to start
+    threads = MIN(threads > 0 ? threads : cpuCount(), count) - 1;
+
+    if(threads > 0)
+    {
+        batch->threads = calloc(threads, sizeof(Thread));
+
+        while(batch->threadsCount < threads 
+            && threadStart(&batch->threads[batch->threadsCount], worker, batch))
+            batch->threadsCount++;
+    }
+
+    return batch;
+}
+
+TIC80_API void tic80_batch_delete(tic80_batch* batch)
+{
+    mutexLock(&batch->lock);
+    batch->job.quit = true;
+    condBroadcast(&batch->start);
+    mutexUnlock(&batch->lock);
+
+    for(s32 i = 0; i < batch->threadsCount; i++)
+        threadJoin(batch->threads[i]);
+
+    condFree(&batch->finish);
+    condFree(&batch->start);
+    mutexFree(&batch->lock);
+
+    for(s32 i = 0; i < batch->count; i++)
+        tic_core_close(batch->instances[i].mem);
+
+    free(batch->threads);
+    free(batch->instances);
+    free(batch);
+}
+
+TIC80_API void tic80_batch_load(tic80_batch* batch, void* cart, s32 size)
+{
+    for(s32 i = 0; i < batch->count; i++)
+    {
+        tic_cart_load(&batch->instances[i].mem->cart, cart, size);
+        tic80_batch_reset(batch, i);
+    }
+}
+
+TIC80_API void tic80_batch_reset(tic80_batch* batch, s32 index)
+{
+    Instance* instance = &batch->instances[index];
+
+    tic_api_reset(instance->mem);
+    instance->frame = 0;
+    instance->status = TIC80_BATCH_RUNNING;
+}
+
+TIC80_API tic80* tic80_batch_get(tic80_batch* batch, s32 index)
+{
+    return &batch->instances[index].mem->product;
+}
+
+TIC80_API u32 tic80_batch_status(tic80_batch* batch, s32 index)
+{
+    return batch->instances[index].status;
+}
+
+TIC80_API s32 tic80_batch_observe(tic80_batch* batch, tic80_batch_obs type, s32 offset, s32 size)
+{
+    switch(type)
+    {
+    case TIC80_BATCH_OBS_SCREEN:
+        offset = 0;
+        size = TIC80_FULLWIDTH * TIC80_FULLHEIGHT 
+            * (batch->format == TIC80_PIXEL_COLOR_INDEX8 ? sizeof(u8) : sizeof(u32));
+        break;
+    case TIC80_BATCH_OBS_RAM:
+        offset = CLAMP(offset, 0, TIC_RAM_SIZE);
+        size = CLAMP(size, 0, TIC_RAM_SIZE - offset);
+        break;
+    default:
+        type = TIC80_BATCH_OBS_NONE;
+        offset = size = 0;
+    }
+
+    batch->obs.type = type;
+    batch->obs.offset = offset;
+    batch->obs.size = size;
+
+    return size;
+}
+
+TIC80_API void tic80_batch_step(tic80_batch* batch, const tic80_input* inputs, void* observations, u32 flags)
+{
+    mutexLock(&batch->lock);
+
+    batch->job.inputs = inputs;
+    batch->job.obs = batch->obs.size ? observations : NULL;
+    batch->job.flags = flags;
+    batch->job.next = 0;
+    batch->job.done = 0;
+    batch->job.generation++;
+
+    condBroadcast(&batch->start);
+
+    runJob(batch);
+
+    while(batch->job.done < batch->count)
+        condWait(&batch->finish, &batch->lock);
+
+    mutexUnlock(&batch->lock);
+}
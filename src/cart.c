@@ -56,6 +56,7 @@ typedef enum
     CHUNK_SCREEN,       // 18
     CHUNK_BINARY,       // 19
     CHUNK_LANG,         // 20
+    CHUNK_BYTECODE,     // 21
 } ChunkType;
 
 typedef struct
@@ -78,7 +79,31 @@ static const u8 Waveforms[] = {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0
 
 static s32 chunkSize(const Chunk* chunk)
 {
-    return chunk->size == 0 && (chunk->type == CHUNK_CODE || chunk->type == CHUNK_BINARY) ? TIC_BANK_SIZE : retro_le_to_cpu16(chunk->size);
+    return chunk->size == 0 && (chunk->type == CHUNK_CODE || chunk->type == CHUNK_BINARY || chunk->type == CHUNK_BYTECODE)
+        ? TIC_BANK_SIZE : retro_le_to_cpu16(chunk->size);
+}
+
+typedef struct {s32 size; const char* data;} BinaryChunk;
+
+// joins the banks of a binary chunk, the last bank goes first
+static void loadBinaryChunks(tic_binary* binary, const BinaryChunk* chunks)
+{
+    u32 total_size = 0;
+    char* ptr = binary->data;
+
+    for(s32 i = TIC_BINARY_BANKS - 1; i >= 0; i--)
+    {
+        const BinaryChunk* chunk = &chunks[i];
+
+        if (chunk->size)
+        {
+            memcpy(ptr, chunk->data, chunk->size);
+            ptr += chunk->size;
+            total_size += chunk->size;
+        }
+    }
+
+    binary->size = total_size;
 }
 
 void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
@@ -151,7 +176,8 @@ void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
     }
 
     struct CodeChunk {s32 size; const char* data;} code[TIC_BANKS] = {0};
-    struct BinaryChunk {s32 size; const char* data;} binary[TIC_BINARY_BANKS] = {0};
+    BinaryChunk binary[TIC_BINARY_BANKS] = {0};
+    BinaryChunk bytecode[TIC_BINARY_BANKS] = {0};
 
     {
         const u8* ptr = buffer;
@@ -173,7 +199,11 @@ void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
             case CHUNK_SCREEN:      LOAD_CHUNK(cart->banks[chunk->bank].screen);            break;
             case CHUNK_LANG:        LOAD_CHUNK(cart->lang);                                 break;
             case CHUNK_BINARY:      
-                binary[chunk->bank] = (struct BinaryChunk){chunkSize(chunk), ptr};
+                binary[chunk->bank] = (BinaryChunk){chunkSize(chunk), ptr};
+                break;
+            case CHUNK_BYTECODE:
+                if(chunk->bank < TIC_BINARY_BANKS)
+                    bytecode[chunk->bank] = (BinaryChunk){chunkSize(chunk), ptr};
                 break;
             case CHUNK_CODE:        
                 code[chunk->bank] = (struct CodeChunk){chunkSize(chunk), ptr};
@@ -224,18 +254,8 @@ void tic_cart_load(tic_cartridge* cart, const u8* buffer, s32 size)
         }
 #undef LOAD_CHUNK
 
-        {
-            u32 total_size = 0;
-            char* ptr = cart->binary.data;
-            RFOR(const struct BinaryChunk*, chunk, binary)
-                if (chunk->size)
-                {
-                    memcpy(ptr, chunk->data, chunk->size);
-                    ptr += chunk->size;
-                    total_size += chunk->size;
-                }
-            cart->binary.size = total_size;
-        }
+        loadBinaryChunks(&cart->binary, binary);
+        loadBinaryChunks(&cart->bytecode, bytecode);
 
         if (!*cart->code.data)
         {
@@ -292,6 +312,21 @@ static u8* saveChunk(u8* buffer, ChunkType type, const void* from, s32 size, s32
     return saveFixedChunk(buffer, type, from, chunkSize, bank);
 }
 
+static u8* saveBinaryChunks(u8* buffer, ChunkType type, const tic_binary* binary)
+{
+    const char* ptr = binary->data;
+    s32 remaining = binary->size;
+
+    if (remaining)
+        for (s32 i = binary->size / TIC_BANK_SIZE; i >= 0; --i, ptr += TIC_BANK_SIZE) 
+        {
+            buffer = saveFixedChunk(buffer, type, ptr, MIN(remaining, TIC_BANK_SIZE), i);
+            remaining -= TIC_BANK_SIZE;
+        }
+
+    return buffer;
+}
+
 s32 tic_cart_save(const tic_cartridge* cart, u8* buffer)
 {
     u8* start = buffer;
@@ -329,19 +364,10 @@ s32 tic_cart_save(const tic_cartridge* cart, u8* buffer)
         buffer = SAVE_CHUNK(CHUNK_SCREEN,   cart->banks[i].screen,          i);
     }
 
-    const char* ptr;
-    if (cart->binary.size) 
-    {
-        ptr = cart->binary.data;
-        s32 remaining = cart->binary.size;
-        for (s32 i = cart->binary.size / TIC_BANK_SIZE; i >= 0; --i, ptr += TIC_BANK_SIZE) 
-        {
-            buffer = saveFixedChunk(buffer, CHUNK_BINARY, ptr, MIN(remaining, TIC_BANK_SIZE), i);
-            remaining -= TIC_BANK_SIZE;
-        }
-    }
+    buffer = saveBinaryChunks(buffer, CHUNK_BINARY, &cart->binary);
+    buffer = saveBinaryChunks(buffer, CHUNK_BYTECODE, &cart->bytecode);
 
-    ptr = cart->code.data;
+    const char* ptr = cart->code.data;
     for(s32 i = strlen(ptr) / TIC_BANK_SIZE; i >= 0; --i, ptr += TIC_BANK_SIZE)
         buffer = saveFixedChunk(buffer, CHUNK_CODE, ptr, MIN(strlen(ptr), TIC_BANK_SIZE), i);
 
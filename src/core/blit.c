@@ -0,0 +1,150 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "core.h"
+
+// row kernels of the blit, vectorized where the target has SSE2 or NEON,
+// define TIC_BLIT_SCALAR to build the portable versions only
+
+#if !defined(TIC_BLIT_SCALAR)
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define TIC_BLIT_SSE2
+#       include <emmintrin.h>
+#   elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#       define TIC_BLIT_NEON
+#       include <arm_neon.h>
+#   endif
+#endif
+
+void tic_core_blit_unpack(const u8* src, u8* dst, s32 count)
+{
+    s32 i = 0;
+
+#if defined(TIC_BLIT_SSE2)
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    for(; i + 32 <= count; i += 32)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i / 2));
+        __m128i lo = _mm_and_si128(v, mask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(lo, hi));
+        _mm_storeu_si128((__m128i*)(dst + i + 16), _mm_unpackhi_epi8(lo, hi));
+    }
+#elif defined(TIC_BLIT_NEON)
+    const uint8x16_t mask = vdupq_n_u8(0x0f);
+
+    for(; i + 32 <= count; i += 32)
+    {
+        uint8x16_t v = vld1q_u8(src + i / 2);
+        uint8x16x2_t pix = {{vandq_u8(v, mask), vshrq_n_u8(v, 4)}};
+
+        vst2q_u8(dst + i, pix);
+    }
+#endif
+
+    for(; i < count; i += 2)
+    {
+        u8 v = src[i / 2];
+        dst[i] = v & 0x0f;
+        dst[i + 1] = v >> 4;
+    }
+}
+
+void tic_core_blit_merge(const u8* bank0, const u8* bank1, u8 clear, u8* dst, s32 count)
+{
+    s32 i = 0;
+
+#if defined(TIC_BLIT_SSE2)
+    const __m128i clr = _mm_set1_epi8(clear);
+    const __m128i base = _mm_set1_epi8(TIC_PALETTE_SIZE);
+
+    for(; i + 16 <= count; i += 16)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(bank0 + i));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(bank1 + i));
+        __m128i m = _mm_cmpeq_epi8(p1, clr);
+
+        _mm_storeu_si128((__m128i*)(dst + i), 
+            _mm_or_si128(_mm_and_si128(m, p0), _mm_andnot_si128(m, _mm_add_epi8(p1, base))));
+    }
+#elif defined(TIC_BLIT_NEON)
+    const uint8x16_t clr = vdupq_n_u8(clear);
+    const uint8x16_t base = vdupq_n_u8(TIC_PALETTE_SIZE);
+
+    for(; i + 16 <= count; i += 16)
+    {
+        uint8x16_t p0 = vld1q_u8(bank0 + i);
+        uint8x16_t p1 = vld1q_u8(bank1 + i);
+
+        vst1q_u8(dst + i, vbslq_u8(vceqq_u8(p1, clr), p0, vaddq_u8(p1, base)));
+    }
+#endif
+
+    for(; i < count; i++)
+        dst[i] = bank1[i] != clear ? bank1[i] + TIC_PALETTE_SIZE : bank0[i];
+}
+
+void tic_core_blit_expand(const u8* src, const u32* pal, u32* dst, s32 count)
+{
+    s32 i = 0;
+
+#if defined(TIC_BLIT_NEON) && defined(__aarch64__)
+    // a table lookup per byte of the color, 32 entries fit in two registers
+    const uint8x16x4_t lo = vld4q_u8((const u8*)pal);
+    const uint8x16x4_t hi = vld4q_u8((const u8*)(pal + 16));
+    const uint8x16x2_t t0 = {{lo.val[0], hi.val[0]}};
+    const uint8x16x2_t t1 = {{lo.val[1], hi.val[1]}};
+    const uint8x16x2_t t2 = {{lo.val[2], hi.val[2]}};
+    const uint8x16x2_t t3 = {{lo.val[3], hi.val[3]}};
+
+    for(; i + 16 <= count; i += 16)
+    {
+        uint8x16_t idx = vld1q_u8(src + i);
+        uint8x16x4_t pix = {{vqtbl2q_u8(t0, idx), vqtbl2q_u8(t1, idx), vqtbl2q_u8(t2, idx), vqtbl2q_u8(t3, idx)}};
+
+        vst4q_u8((u8*)(dst + i), pix);
+    }
+#elif defined(TIC_BLIT_NEON)
+    const uint8x8x4_t e0 = vld4_u8((const u8*)pal);
+    const uint8x8x4_t e1 = vld4_u8((const u8*)(pal + 8));
+    const uint8x8x4_t e2 = vld4_u8((const u8*)(pal + 16));
+    const uint8x8x4_t e3 = vld4_u8((const u8*)(pal + 24));
+    const uint8x8x4_t t0 = {{e0.val[0], e1.val[0], e2.val[0], e3.val[0]}};
+    const uint8x8x4_t t1 = {{e0.val[1], e1.val[1], e2.val[1], e3.val[1]}};
+    const uint8x8x4_t t2 = {{e0.val[2], e1.val[2], e2.val[2], e3.val[2]}};
+    const uint8x8x4_t t3 = {{e0.val[3], e1.val[3], e2.val[3], e3.val[3]}};
+
+    for(; i + 8 <= count; i += 8)
+    {
+        uint8x8_t idx = vld1_u8(src + i);
+        uint8x8x4_t pix = {{vtbl4_u8(t0, idx), vtbl4_u8(t1, idx), vtbl4_u8(t2, idx), vtbl4_u8(t3, idx)}};
+
+        vst4_u8((u8*)(dst + i), pix);
+    }
+#endif
+
+    // SSE2 has no byte shuffles, a plain lookup is as fast as it gets there
+    for(; i < count; i++)
+        dst[i] = pal[src[i]];
+}
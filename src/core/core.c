@@ -23,6 +23,7 @@
 #include "api.h"
 #include "core.h"
 #include "tilesheet.h"
+#include "ext/md5.h"
 
 #include <assert.h>
 #include <string.h>
@@ -46,20 +47,33 @@ static_assert(sizeof(((tic_vram *)0)->vars) == 4, "tic_vram vars");
 static_assert(sizeof(tic_vram) == TIC_VRAM_SIZE,    "tic_vram");
 static_assert(sizeof(tic_ram) == TIC_RAM_SIZE,      "tic_ram");
 
+// VRAM part of the RAM is served by the active vbank, wherever it is stored
+static inline u8* ramptr(tic_core* core, s32 address)
+{
+    return address < TIC_VRAM_SIZE ? (u8*)tic_core_vram(core) : (u8*)core->memory.ram;
+}
+
+static inline u8* pokeptr(tic_core* core, s32 address)
+{
+    tic_core_blit_dirty(core, address, 1);
+    tic_core_tiles_dirty(core, address, 1);
+    return ramptr(core, address);
+}
+
 u8 tic_api_peek(tic_mem* memory, s32 address, s32 bits)
 {
     if (address < 0)
         return 0;
 
-    const u8* ram = (u8*)memory->ram;
+    tic_core* core = (tic_core*)memory;
     enum{RamBits = sizeof(tic_ram) * BITS_IN_BYTE};
 
     switch(bits)
     {
-    case 1: if(address < RamBits / 1) return tic_tool_peek1(ram, address);
-    case 2: if(address < RamBits / 2) return tic_tool_peek2(ram, address);
-    case 4: if(address < RamBits / 4) return tic_tool_peek4(ram, address);
-    case 8: if(address < RamBits / 8) return ram[address];
+    case 1: if(address < RamBits / 1) return tic_tool_peek1(ramptr(core, address >> 3), address);
+    case 2: if(address < RamBits / 2) return tic_tool_peek2(ramptr(core, address >> 2), address);
+    case 4: if(address < RamBits / 4) return tic_tool_peek4(ramptr(core, address >> 1), address);
+    case 8: if(address < RamBits / 8) return ramptr(core, address)[address];
     }
 
     return 0;
@@ -71,15 +85,14 @@ void tic_api_poke(tic_mem* memory, s32 address, u8 value, s32 bits)
         return;
 
     tic_core* core = (tic_core*)memory;
-    u8* ram = (u8*)memory->ram;
     enum{RamBits = sizeof(tic_ram) * BITS_IN_BYTE};
     
     switch(bits)
     {
-    case 1: if(address < RamBits / 1) tic_tool_poke1(ram, address, value); break;
-    case 2: if(address < RamBits / 2) tic_tool_poke2(ram, address, value); break;
-    case 4: if(address < RamBits / 4) tic_tool_poke4(ram, address, value); break;
-    case 8: if(address < RamBits / 8) ram[address] = value; break;
+    case 1: if(address < RamBits / 1) tic_tool_poke1(pokeptr(core, address >> 3), address, value); break;
+    case 2: if(address < RamBits / 2) tic_tool_poke2(pokeptr(core, address >> 2), address, value); break;
+    case 4: if(address < RamBits / 4) tic_tool_poke4(pokeptr(core, address >> 1), address, value); break;
+    case 8: if(address < RamBits / 8) pokeptr(core, address)[address] = value; break;
     }
 }
 
@@ -125,8 +138,13 @@ void tic_api_memcpy(tic_mem* memory, s32 dst, s32 src, s32 size)
         && dst <= bound
         && src <= bound)
     {
+        if(MIN(dst, src) < TIC_VRAM_SIZE)
+            tic_core_vbank_sync(memory);
+
         u8* base = (u8*)memory->ram;
         memcpy(base + dst, base + src, size);
+        tic_core_blit_dirty(core, dst, size);
+        tic_core_tiles_dirty(core, dst, size);
     }
 }
 
@@ -140,8 +158,13 @@ void tic_api_memset(tic_mem* memory, s32 dst, u8 val, s32 size)
         && dst >= 0
         && dst <= bound)
     {
+        if(dst < TIC_VRAM_SIZE)
+            tic_core_vbank_sync(memory);
+
         u8* base = (u8*)memory->ram;
         memset(base + dst, val, size);
+        tic_core_blit_dirty(core, dst, size);
+        tic_core_tiles_dirty(core, dst, size);
     }
 }
 
@@ -177,12 +200,12 @@ static inline void sync(void* dst, void* src, s32 size, bool rev)
 
 static inline tic_vram* vbank0(tic_core* core)
 {
-    return core->state.vbank.id ? &core->state.vbank.mem : &core->memory.ram->vram;
+    return tic_core_vbank(core, 0);
 }
 
 static inline tic_vram* vbank1(tic_core* core)
 {
-    return core->state.vbank.id ? &core->memory.ram->vram : &core->state.vbank.mem;
+    return tic_core_vbank(core, 1);
 }
 
 void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
@@ -198,6 +221,8 @@ void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
 
     enum { Count = COUNT_OF(Sections), Mask = (1 << Count) - 1 };
 
+    tic_core_vbank_sync(tic);
+
     if (mask == 0) mask = Mask;
 
     mask &= ~core->state.synced & Mask;
@@ -223,6 +248,12 @@ void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
             else
             {
                 sync(tic->ram->data + Sections[i].ram, (u8*)bankPtr + Sections[i].bank, size, toCart);
+
+                if(!toCart)
+                {
+                    tic_core_blit_dirty(core, Sections[i].ram, size);
+                    tic_core_tiles_dirty(core, Sections[i].ram, size);
+                }
             }
         }        
     }
@@ -367,8 +398,11 @@ void tic_api_reset(tic_mem* memory)
     // is copied to previous. This duplicates the prior behavior of
     // `ram.input.keyboard` (which existing outside `state`).
     u32 kb_now = core->state.keyboard.now.data;
+    tic_core_vbank_sync(memory);
     ZEROMEM(core->state);
     core->state.keyboard.now.data = kb_now;
+    core->path.target = -1;
+    core->canvas.open = false;
     tic_api_clip(memory, 0, 0, TIC80_WIDTH, TIC80_HEIGHT);
 
     resetVbank(memory);
@@ -383,6 +417,9 @@ void tic_api_reset(tic_mem* memory)
     soundClear(memory);
     updateSaveid(memory);
     font2ram(memory);
+
+    tic_core_blit_invalidate(memory, 0, TIC80_FULLHEIGHT);
+    tic_core_tiles_invalidate(memory, 0, TIC_TILES);
 }
 
 static void cart2ram(tic_mem* memory)
@@ -412,16 +449,241 @@ static void tic_close_current_vm(tic_core* core)
         core->currentScript->close( (tic_mem*)core );
         core->currentVM = NULL;
     }
+
+    tic_core_heap_reset(core);
+
     if (core->memory.ram == NULL) {
         core->memory.ram = core->memory.base_ram;
     }
 }
 
+const void* tic_core_compiled(tic_core* core, const char* code, s32* size)
+{
+    if(core->compiled.data
+        && core->compiled.script == core->currentScript
+        && strcmp(core->compiled.code, code) == 0)
+    {
+        *size = core->compiled.size;
+        return core->compiled.data;
+    }
+
+    return NULL;
+}
+
+static void freeCompiled(tic_core* core)
+{
+    free(core->compiled.code);
+    free(core->compiled.data);
+    ZEROMEM(core->compiled);
+}
+
+void tic_core_compiled_set(tic_core* core, const char* code, const void* data, s32 size)
+{
+    freeCompiled(core);
+
+    s32 length = (s32)strlen(code) + 1;
+    core->compiled.code = malloc(length);
+    core->compiled.data = malloc(size);
+
+    if(core->compiled.code && core->compiled.data)
+    {
+        memcpy(core->compiled.code, code, length);
+        memcpy(core->compiled.data, data, size);
+        core->compiled.script = core->currentScript;
+        core->compiled.size = size;
+    }
+    else freeCompiled(core);
+}
+
+// cart bytecode starts with the script id, the length of the runtime version,
+// the length and the hash of the code it was compiled from, then the version, the chunk and its signature
+enum {BytecodeHeader = 10, BytecodeSign = 16};
+
+static u32 codeHash(const char* code)
+{
+    u32 hash = 2166136261u;
+
+    for(const u8* ptr = (const u8*)code; *ptr; ptr++)
+        hash = (hash ^ *ptr) * 16777619u;
+
+    return hash;
+}
+
+// HMAC-MD5 of the bytecode with the key of this install
+static void signBytecode(const u8* key, const u8* data, s32 size, u8 sign[BytecodeSign])
+{
+    enum {Block = 64};
+
+    u8 pad[Block];
+    MD5_CTX ctx;
+
+    memset(pad, 0x36, sizeof pad);
+    for(s32 i = 0; i < TIC_BYTECODE_KEY; i++)
+        pad[i] ^= key[i];
+
+    MD5_Init(&ctx);
+    MD5_Update(&ctx, pad, sizeof pad);
+    MD5_Update(&ctx, data, size);
+    MD5_Final(sign, &ctx);
+
+    memset(pad, 0x5c, sizeof pad);
+    for(s32 i = 0; i < TIC_BYTECODE_KEY; i++)
+        pad[i] ^= key[i];
+
+    MD5_Init(&ctx);
+    MD5_Update(&ctx, pad, sizeof pad);
+    MD5_Update(&ctx, sign, BytecodeSign);
+    MD5_Final(sign, &ctx);
+}
+
+static void hashBytecode(const tic_binary* bytecode, u8 hash[BytecodeSign])
+{
+    MD5_CTX ctx;
+    MD5_Init(&ctx);
+    MD5_Update(&ctx, bytecode->data, MIN(bytecode->size, sizeof bytecode->data));
+    MD5_Final(hash, &ctx);
+}
+
+static inline u8* writeU32(u8* ptr, u32 value)
+{
+    for(s32 i = 0; i < 4; i++)
+        *ptr++ = value >> (i * BITS_IN_BYTE);
+
+    return ptr;
+}
+
+static inline u32 readU32(const u8* ptr)
+{
+    return ptr[0] | ptr[1] << 8 | ptr[2] << 16 | (u32)ptr[3] << 24;
+}
+
+bool tic_core_bytecode_store(tic_mem* memory)
+{
+    tic_core* core = (tic_core*)memory;
+    tic_binary* bytecode = &memory->cart.bytecode;
+    const tic_script_config* config = tic_core_script_config(memory);
+    const char* code = memory->cart.code.data;
+    const char* version = config->bytecodeVersion;
+
+    bytecode->size = 0;
+
+    if(!version || !core->compiled.data || !core->bytecode.keyed
+        || core->compiled.script != config
+        || strcmp(core->compiled.code, code) != 0)
+        return false;
+
+    s32 tag = (s32)strlen(version);
+
+    if(BytecodeHeader + tag + core->compiled.size + BytecodeSign > sizeof bytecode->data)
+        return false;
+
+    u8* ptr = (u8*)bytecode->data;
+    *ptr++ = config->id;
+    *ptr++ = tag;
+    ptr = writeU32(ptr, (u32)strlen(code));
+    ptr = writeU32(ptr, codeHash(code));
+
+    memcpy(ptr, version, tag);
+    memcpy(ptr + tag, core->compiled.data, core->compiled.size);
+    ptr += tag + core->compiled.size;
+
+    signBytecode(core->bytecode.key, (const u8*)bytecode->data, (s32)(ptr - (u8*)bytecode->data), ptr);
+    bytecode->size = BytecodeHeader + tag + core->compiled.size + BytecodeSign;
+
+    return true;
+}
+
+void tic_core_bytecode_key(tic_mem* memory, const u8* key)
+{
+    tic_core* core = (tic_core*)memory;
+    memcpy(core->bytecode.key, key, TIC_BYTECODE_KEY);
+    core->bytecode.keyed = true;
+}
+
+void tic_core_bytecode_trust(tic_mem* memory, const tic_binary* bytecode)
+{
+    tic_core* core = (tic_core*)memory;
+    hashBytecode(bytecode, core->bytecode.trusted);
+    core->bytecode.embedded = true;
+}
+
+// the bytecode is signed with the key of this install or it's the one of the cart the app is built with
+static bool trustedBytecode(tic_core* core, const tic_binary* bytecode)
+{
+    u8 sign[BytecodeSign];
+
+    if(core->bytecode.embedded)
+    {
+        hashBytecode(bytecode, sign);
+
+        if(memcmp(sign, core->bytecode.trusted, sizeof sign) == 0)
+            return true;
+    }
+
+    if(core->bytecode.keyed)
+    {
+        s32 size = bytecode->size - BytecodeSign;
+        signBytecode(core->bytecode.key, (const u8*)bytecode->data, size, sign);
+
+        if(memcmp(sign, (const u8*)bytecode->data + size, sizeof sign) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// the chunk stored in a trusted cart becomes the compiled one if it's made by the same runtime from the same code,
+// the script still compiles the code if the runtime rejects the chunk
+static void loadBytecode(tic_core* core, const char* code)
+{
+    const tic_binary* bytecode = &core->memory.cart.bytecode;
+    const char* version = core->currentScript->bytecodeVersion;
+    s32 size;
+
+    if(!version || tic_core_compiled(core, code, &size))
+        return;
+
+    const u8* ptr = (const u8*)bytecode->data;
+    s32 tag = (s32)strlen(version);
+
+    if(bytecode->size > BytecodeHeader + tag + BytecodeSign
+        && bytecode->size <= sizeof bytecode->data
+        && ptr[0] == core->currentScript->id
+        && ptr[1] == tag
+        && readU32(ptr + 2) == strlen(code)
+        && readU32(ptr + 6) == codeHash(code)
+        && memcmp(ptr + BytecodeHeader, version, tag) == 0
+        && trustedBytecode(core, bytecode))
+    {
+        tic_core_compiled_set(core, code, ptr + BytecodeHeader + tag, bytecode->size - BytecodeHeader - tag - BytecodeSign);
+    }
+}
+
+// the cart caps the memory of its script VM with the `memory` metatag, in megabytes
+static u64 heapCap(tic_core* core, const tic_script_config* config)
+{
+    u64 cap = 0;
+    char* value = tic_tool_metatag(core->memory.cart.code.data, "memory", config->singleComment);
+
+    if(value)
+    {
+        cap = (u64)MAX(atoi(value), 0) << 20;
+        free(value);
+    }
+
+    return cap;
+}
+
 static bool tic_init_vm(tic_core* core, const char* code, const tic_script_config* config)
 {
     tic_close_current_vm(core);
     // set current script config and init
     core->currentScript = config;
+    core->gc.cycle = false;
+    core->gc.live = 0;
+    core->memory.stats.heap.peak = 0;
+    core->memory.stats.heap.cap = heapCap(core, config);
+    loadBytecode(core, code);
     bool done = config->init( (tic_mem*) core , code);
     if(!done)
     {
@@ -447,14 +709,124 @@ s32 tic_api_vbank(tic_mem* tic, s32 bank)
     case 1:
         if(core->state.vbank.id != bank)
         {
-            SWAP(tic->ram->vram, core->state.vbank.mem, tic_vram);
             core->state.vbank.id = bank;
+            core->state.vbank.swapped = !core->state.vbank.swapped;
         }
     }
 
     return prev;
 }
 
+// VRAM bytes the raster table can write, from the palette to the screen offset
+enum
+{
+    RasterStart = offsetof(tic_vram, palette),
+    RasterPalette = sizeof(tic_palette),
+    RasterBorder = offsetof(tic_vram, vars) - RasterStart,
+    RasterSize = RasterBorder + 3,
+};
+
+bool tic_api_raster(tic_mem* memory, s32 row, s32 address, s32 value)
+{
+    tic_core* core = (tic_core*)memory;
+    s32* count = &core->state.raster.count;
+    tic_raster_entry* entries = core->state.raster.entries;
+
+    if(row < 0)
+    {
+        *count = 0;
+        return true;
+    }
+
+    address -= RasterStart;
+
+    if(row >= TIC80_FULLHEIGHT || address < 0 || address >= RasterSize
+        || (address >= RasterPalette && address < RasterBorder))
+        return false;
+
+    const tic_raster_entry entry = {row, core->state.vbank.id, address, value};
+
+    // the later write to the same byte on the row replaces the previous one
+    s32 i = 0;
+    for(; i < *count && entries[i].row <= row; ++i)
+        if(entries[i].row == row && entries[i].bank == entry.bank && entries[i].address == entry.address)
+        {
+            entries[i].value = entry.value;
+            return true;
+        }
+
+    if(*count == TIC_RASTER_SIZE)
+        return false;
+
+    memmove(entries + i + 1, entries + i, (*count - i) * sizeof *entries);
+    entries[i] = entry;
+    ++*count;
+
+    return true;
+}
+
+void tic_core_vbank_sync(tic_mem* tic)
+{
+    tic_core* core = (tic_core*)tic;
+
+    if(core->state.vbank.swapped)
+    {
+        SWAP(tic->ram->vram, core->state.vbank.mem, tic_vram);
+        core->state.vbank.swapped = false;
+    }
+}
+
+static inline bool pacedGC(tic_core* core)
+{
+    return core->currentVM && core->currentScript && core->currentScript->gc.step;
+}
+
+// a new cycle starts when the heap has doubled since the last one, like the runtimes do by default,
+// and the runtime collects by itself again if the cart allocates faster than the budget collects
+enum {GCMinHeap = 1 << 20, GCPause = 2, GCLimit = 4};
+
+// microseconds of a real clock, the tick counter is virtual in the headless and batch runs
+static u64 gcClock()
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    return (u64)clock() * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+static void collectGarbage(tic_core* core)
+{
+    if(!core->gc.budget || !pacedGC(core))
+        return;
+
+    tic_mem* tic = (tic_mem*)core;
+    const tic_script_config* script = core->currentScript;
+
+    u64 start = gcClock();
+    u64 deadline = start + core->gc.budget;
+
+    if(!core->gc.cycle && script->gc.heap(tic) >= core->gc.live * GCPause)
+        core->gc.cycle = true;
+
+    while(core->gc.cycle && gcClock() < deadline)
+        if(script->gc.step(tic))
+        {
+            core->gc.cycle = false;
+            core->gc.live = script->gc.heap(tic);
+            tic->stats.gc.cycles++;
+        }
+
+    script->gc.limit(tic, MAX(core->gc.live, GCMinHeap) * GCLimit);
+
+    u64 time = gcClock() - start;
+    tic->stats.gc.time += time;
+    tic->stats.gc.frame = time;
+    tic->stats.gc.heap = script->gc.heap(tic);
+}
+
 void tic_core_tick(tic_mem* tic, tic_tick_data* data)
 {
     tic_core* core = (tic_core*)tic;
@@ -510,12 +882,17 @@ void tic_core_tick(tic_mem* tic, tic_tick_data* data)
     }
 
     core->state.tick(tic);
+
+    collectGarbage(core);
 }
 
 void tic_core_pause(tic_mem* memory)
 {
     tic_core* core = (tic_core*)memory;
 
+    // the canvas isn't a part of the state, it's packed now so the saved clip is the screen one
+    tic_api_canvas(memory, -1, 0, 0);
+
     memcpy(&core->pause.state, &core->state, sizeof(tic_core_state_data));
     memcpy(&core->pause.ram, memory->ram, sizeof(tic_ram));
     core->pause.input = memory->input.data;
@@ -537,6 +914,8 @@ void tic_core_resume(tic_mem* memory)
         memcpy(memory->ram, &core->pause.ram, sizeof(tic_ram));
         core->data->start = core->pause.time.start + core->data->counter(core->data->data) - core->pause.time.paused;
         memory->input.data = core->pause.input;
+        tic_core_blit_invalidate(memory, 0, TIC80_FULLHEIGHT);
+        tic_core_tiles_invalidate(memory, 0, TIC_TILES);
     }
     else
     {
@@ -551,6 +930,7 @@ void tic_core_close(tic_mem* memory)
     core->state.initialized = false;
 
     tic_close_current_vm(core);
+    freeCompiled(core);
 
     blip_delete(core->blip.left);
     blip_delete(core->blip.right);
@@ -560,6 +940,7 @@ void tic_core_close(tic_mem* memory)
 #else
     free(memory->product.screen);
 #endif
+    free(memory->product.palettes);
     free(memory->product.samples.buffer);
     free(core);
 }
@@ -594,7 +975,28 @@ void tic_core_tick_end(tic_mem* memory)
     core->state.keyboard.previous.data = core->state.keyboard.now.data;
     core->state.gamepads.previous.data = core->state.gamepads.now.data;
 
+    core->state.remap.ticks++;
+
+    // a canvas left open by the frame is packed as if it was closed at its end
+    tic_api_canvas(memory, -1, 0, 0);
+
     tic_core_sound_tick_end(memory);
+    tic_core_vbank_sync(memory);
+}
+
+void tic_core_step(tic_mem* memory, tic_tick_data* data, u32 flags)
+{
+    tic_core_tick_start(memory);
+    tic_core_tick(memory, data);
+    tic_core_tick_end(memory);
+
+    if(!(flags & TIC80_STEP_SKIP_BLIT))
+        tic_core_blit(memory);
+
+    if(flags & TIC80_STEP_SKIP_SOUND)
+        tic_core_skip_sound(memory);
+    else
+        tic_core_synth_sound(memory);
 }
 
 // copied from SDL2
@@ -627,16 +1029,32 @@ static inline void memset4(void* dst, u32 val, u32 dwords)
 #endif
 }
 
-static inline void updpal(tic_mem* tic, tic_blitpal* pal0, tic_blitpal* pal1)
+// expands the vbank palettes to the screen format, only the ones changed since the last time
+static inline void updpal(tic_core* core)
 {
-    tic_core* core = (tic_core*)tic;
-    *pal0 = tic_tool_palette_blit(&vbank0(core)->palette, core->screen_format);
-    *pal1 = tic_tool_palette_blit(&vbank1(core)->palette, core->screen_format);
+    if(core->screen_format == TIC80_PIXEL_COLOR_INDEX8)
+        return;
+
+    for(s32 i = 0; i < TIC_VBANKS; i++)
+    {
+        const tic_palette* src = &tic_core_vbank(core, i)->palette;
+        tic_palette* last = &core->blit.palette.src[i];
+
+        if(core->blit.palette.valid[i] && MEMCMP(*src, *last))
+            continue;
+
+        tic_blitpal pal = tic_tool_palette_blit(src, core->screen_format);
+        memcpy(core->blit.palette.data + i * TIC_PALETTE_SIZE, pal.data, sizeof pal);
+
+        *last = *src;
+        core->blit.palette.valid[i] = true;
+        core->memory.stats.blit.palettes++;
+    }
 }
 
-static inline void updbdr(tic_mem* tic, s32 row, u32* ptr, tic_blit_callback clb, tic_blitpal* pal0, tic_blitpal* pal1)
+static inline void updbdr(tic_core* core, s32 row, tic_blit_callback clb)
 {
-    tic_core* core = (tic_core*)tic;
+    tic_mem* tic = (tic_mem*)core;
 
     if(clb.border) clb.border(tic, row, clb.data);
 
@@ -648,68 +1066,237 @@ static inline void updbdr(tic_mem* tic, s32 row, u32* ptr, tic_blit_callback clb
     }
 
     if(clb.border || clb.scanline)
-        updpal(tic, pal0, pal1);
+        updpal(core);
+}
+
+// the VRAM bytes of the raster table as the cart and as the blit see them, the table writes
+// go to the blit copy, which is in VRAM only while the row is blitted, not while the cart code runs
+typedef struct
+{
+    u8 cart[TIC_VBANKS][RasterSize];
+    u8 blit[TIC_VBANKS][RasterSize];
+} RasterVars;
 
-    memset4(ptr, pal0->data[vbank0(core)->vars.border], TIC80_FULLWIDTH);
+static inline u8* rastervars(tic_core* core, s32 bank)
+{
+    return (u8*)tic_core_vbank(core, bank) + RasterStart;
 }
 
-static inline u32 blitpix(tic_mem* tic, s32 offset0, s32 offset1, const tic_blitpal* pal0, const tic_blitpal* pal1)
+// puts the cart copy in VRAM for the SCN/BDR callbacks of the row
+static inline void rastercart(tic_core* core, const RasterVars* vars)
 {
-    tic_core* core = (tic_core*)tic;
-    u32 pix = tic_tool_peek4(vbank1(core)->screen.data, offset1);
+    for(s32 i = 0; i < TIC_VBANKS; i++)
+        memcpy(rastervars(core, i), vars->cart[i], RasterSize);
+}
 
-    return pix != vbank1(core)->vars.clear
-        ? pal1->data[pix]
-        : pal0->data[tic_tool_peek4(vbank0(core)->screen.data, offset0)];
+// takes the callback writes, they replace the table values, then writes the table entries of the row
+// and puts the blit copy in VRAM
+static inline void updraster(tic_core* core, s32 row, const tic_raster_entry** it, const tic_raster_entry* end, RasterVars* vars)
+{
+    for(s32 i = 0; i < TIC_VBANKS; i++)
+    {
+        const u8* src = rastervars(core, i);
+
+        for(s32 j = 0; j < RasterSize; j++)
+            if(src[j] != vars->cart[i][j])
+                vars->cart[i][j] = vars->blit[i][j] = src[j];
+    }
+
+    for(; *it != end && (*it)->row == row; ++*it)
+        vars->blit[(*it)->bank][(*it)->address] = (*it)->value;
+
+    for(s32 i = 0; i < TIC_VBANKS; i++)
+        memcpy(rastervars(core, i), vars->blit[i], RasterSize);
+}
+
+// unpacks the screen row of the bank to palette indices, twice in a row
+// when the bank is scrolled horizontally, so the row starts at the returned x
+static inline s32 unpackrow(const tic_vram* bank, s32 y, u8* dst)
+{
+    s32 offsetX = bank->vars.offset.x;
+    s32 offsetY = bank->vars.offset.y;
+
+    tic_core_blit_unpack(bank->screen.data + (y + offsetY + TIC80_HEIGHT) % TIC80_HEIGHT * TIC80_WIDTH / 2, 
+        dst, TIC80_WIDTH);
+
+    if(offsetX == 0)
+        return 0;
+
+    memcpy(dst + TIC80_WIDTH, dst, TIC80_WIDTH);
+    return (offsetX + TIC80_WIDTH) % TIC80_WIDTH;
+}
+
+// composes a screen row of vbank1 over vbank0 into palette indices,
+// 0..15 are vbank0 colors and 16..31 are vbank1 colors
+static void blitrow(tic_core* core, s32 y, u8* dst)
+{
+    const tic_vram* bank0 = vbank0(core);
+    const tic_vram* bank1 = vbank1(core);
+
+    u8 row0[TIC80_WIDTH * 2];
+    u8 row1[TIC80_WIDTH * 2];
+
+    s32 x0 = unpackrow(bank0, y, row0);
+    s32 x1 = unpackrow(bank1, y, row1);
+
+    tic_core_blit_merge(row0 + x0, row1 + x1, bank1->vars.clear, dst, TIC80_WIDTH);
+}
+
+static void blitrgba(tic_core* core, s32 row)
+{
+    const u32* pal = core->blit.palette.data;
+    u32* dst = core->memory.product.screen + row * TIC80_FULLWIDTH;
+    u32 border = pal[vbank0(core)->vars.border];
+
+    if(row < TIC80_MARGIN_TOP || row >= TIC80_FULLHEIGHT - TIC80_MARGIN_BOTTOM)
+    {
+        memset4(dst, border, TIC80_FULLWIDTH);
+        return;
+    }
+
+    u8 line[TIC80_WIDTH];
+    blitrow(core, row - TIC80_MARGIN_TOP, line);
+
+    memset4(dst, border, TIC80_MARGIN_LEFT);
+    tic_core_blit_expand(line, pal, dst + TIC80_MARGIN_LEFT, TIC80_WIDTH);
+    memset4(dst + TIC80_MARGIN_LEFT + TIC80_WIDTH, border, TIC80_MARGIN_RIGHT);
+}
+
+static void blitindex(tic_core* core, s32 row)
+{
+    tic80* product = &core->memory.product;
+    u8* dst = (u8*)product->screen + row * TIC80_FULLWIDTH;
+    u8* pal = product->palettes + row * TIC80_INDEX8_COLORS * sizeof(tic_rgb);
+
+    memcpy(pal, vbank0(core)->palette.data, sizeof(tic_palette));
+    memcpy(pal + sizeof(tic_palette), vbank1(core)->palette.data, sizeof(tic_palette));
+
+    if(row < TIC80_MARGIN_TOP || row >= TIC80_FULLHEIGHT - TIC80_MARGIN_BOTTOM)
+        memset(dst, vbank0(core)->vars.border, TIC80_FULLWIDTH);
+    else
+    {
+        memset(dst, vbank0(core)->vars.border, TIC80_MARGIN_LEFT);
+        blitrow(core, row - TIC80_MARGIN_TOP, dst + TIC80_MARGIN_LEFT);
+        memset(dst + TIC80_MARGIN_LEFT + TIC80_WIDTH, vbank0(core)->vars.border, TIC80_MARGIN_RIGHT);
+    }
+}
+
+// checks if anything the output row depends on changed since it was blitted
+static bool updrow(tic_core* core, s32 row)
+{
+    const tic_vram* bank0 = vbank0(core);
+    const tic_vram* bank1 = vbank1(core);
+
+    const tic_blit_row state =
+    {
+        .palette = {bank0->palette, bank1->palette},
+        .border = bank0->vars.border,
+        .clear = bank1->vars.clear,
+        .offset = {*(u16*)&bank0->vars.offset, *(u16*)&bank1->vars.offset},
+    };
+
+    // untracked RAM is written without marking the rows, so every row could have changed
+    bool changed = core->blit.stale[row] || !tic_core_ram_tracked(core) || !MEMCMP(state, core->blit.rows[row]);
+
+    s32 y = row - TIC80_MARGIN_TOP;
+
+    // the flags are cleared after the frame, SCN/BDR can move the offset so more rows show the same source row
+    if(y >= 0 && y < TIC80_HEIGHT)
+        changed |= core->blit.dirty[0][(y + bank0->vars.offset.y + TIC80_HEIGHT) % TIC80_HEIGHT]
+            || core->blit.dirty[1][(y + bank1->vars.offset.y + TIC80_HEIGHT) % TIC80_HEIGHT];
+
+    if(changed)
+    {
+        core->blit.rows[row] = state;
+        core->blit.stale[row] = false;
+    }
+
+    return changed;
 }
 
 void tic_core_blit_ex(tic_mem* tic, tic_blit_callback clb)
 {
     tic_core* core = (tic_core*)tic;
+    bool indexed = core->screen_format == TIC80_PIXEL_COLOR_INDEX8;
 
-    tic_blitpal pal0, pal1;
-    updpal(tic, &pal0, &pal1);
+    updpal(core);
 
-    s32 row = 0;
-    u32* rowPtr = tic->product.screen;
+    const tic_raster_entry* raster = core->state.raster.entries;
+    const tic_raster_entry* rasterEnd = raster + core->state.raster.count;
 
-#define UPDBDR() updbdr(tic, row, rowPtr, clb, &pal0, &pal1)
+    // the table writes are only visible to the blit, the cart keeps its own VRAM values
+    RasterVars vars;
+    const bool rastered = raster != rasterEnd;
 
-    for(; row != TIC80_MARGIN_TOP; ++row, rowPtr += TIC80_FULLWIDTH)
-        UPDBDR();
+    if(rastered)
+        for(s32 i = 0; i < TIC_VBANKS; i++)
+        {
+            memcpy(vars.cart[i], rastervars(core, i), RasterSize);
+            memcpy(vars.blit[i], vars.cart[i], RasterSize);
+        }
 
-    for(; row != TIC80_FULLHEIGHT - TIC80_MARGIN_BOTTOM; ++row)
+    for(s32 row = 0; row != TIC80_FULLHEIGHT; ++row)
     {
-        UPDBDR();
-        rowPtr += TIC80_MARGIN_LEFT;
+        if(rastered)
+            rastercart(core, &vars);
+
+        updbdr(core, row, clb);
 
-        if(*(u16*)&vbank0(core)->vars.offset == 0 && *(u16*)&vbank1(core)->vars.offset == 0)
+        if(rastered)
         {
-            // render line without XY offsets
-            for(s32 x = (row - TIC80_MARGIN_TOP) * TIC80_WIDTH, end = x + TIC80_WIDTH; x != end; ++x)
-                *rowPtr++ = blitpix(tic, x, x, &pal0, &pal1);
+            updraster(core, row, &raster, rasterEnd, &vars);
+            updpal(core);
         }
-        else
+
+        if(!updrow(core, row))
         {
-            // render line with XY offsets
-            enum{OffsetY = TIC80_HEIGHT - TIC80_MARGIN_TOP};
-            s32 start0 = (row + vbank0(core)->vars.offset.y + OffsetY) % TIC80_HEIGHT * TIC80_WIDTH;
-            s32 start1 = (row + vbank1(core)->vars.offset.y + OffsetY) % TIC80_HEIGHT * TIC80_WIDTH;
-            s32 offsetX0 = vbank0(core)->vars.offset.x;
-            s32 offsetX1 = vbank1(core)->vars.offset.x;
-
-            for(s32 x = TIC80_WIDTH; x != 2 * TIC80_WIDTH; ++x)
-                *rowPtr++ = blitpix(tic, (x + offsetX0) % TIC80_WIDTH + start0, 
-                    (x + offsetX1) % TIC80_WIDTH + start1, &pal0, &pal1);
+            tic->stats.blit.skipped++;
+            continue;
         }
 
-        rowPtr += TIC80_MARGIN_RIGHT;
+        if(indexed)
+            blitindex(core, row);
+        else
+            blitrgba(core, row);
     }
 
-    for(; row != TIC80_FULLHEIGHT; ++row, rowPtr += TIC80_FULLWIDTH)
-        UPDBDR();
+    tic->stats.blit.rows += TIC80_FULLHEIGHT;
+    ZEROMEM(core->blit.dirty);
+
+    if(rastered)
+        rastercart(core, &vars);
+
+    tic_core_vbank_sync(tic);
+}
+
+void tic_core_blit_invalidate(tic_mem* tic, s32 row, s32 count)
+{
+    tic_core* core = (tic_core*)tic;
 
-#undef  UPDBDR
+    for(s32 i = MAX(row, 0), end = MIN(row + count, TIC80_FULLHEIGHT); i < end; ++i)
+        core->blit.stale[i] = true;
+}
+
+void tic_core_tiles_invalidate(tic_mem* tic, s32 tile, s32 count)
+{
+    tic_core_tiles_dirty((tic_core*)tic, offsetof(tic_ram, tiles) + tile * sizeof(tic_tile), count * sizeof(tic_tile));
+}
+
+void tic_core_perspective(tic_mem* tic, s32 span)
+{
+    tic_core* core = (tic_core*)tic;
+
+    core->raster.perspective = CLAMP(span, 1, TIC80_WIDTH);
+}
+
+void tic_core_gc(tic_mem* tic, s32 budget)
+{
+    tic_core* core = (tic_core*)tic;
+
+    core->gc.budget = MAX(budget, 0);
+
+    if(!core->gc.budget && pacedGC(core))
+        core->currentScript->gc.limit(tic, 0);
 }
 
 static inline void scanline(tic_mem* memory, s32 row, void* data)
@@ -754,6 +1341,10 @@ tic_mem* tic_core_create(s32 samplerate, tic80_pixel_color_format format)
 #else
     product->screen = malloc(TIC80_FULLWIDTH * TIC80_FULLHEIGHT * sizeof product->screen[0]);
 #endif
+
+    if(format == TIC80_PIXEL_COLOR_INDEX8)
+        product->palettes = malloc(TIC80_FULLHEIGHT * TIC80_INDEX8_COLORS * sizeof(tic_rgb));
+
     product->samples.count = samplerate * TIC80_SAMPLE_CHANNELS / TIC80_FRAMERATE;
     product->samples.buffer = malloc(product->samples.count * TIC80_SAMPLESIZE);
 
@@ -29,6 +29,16 @@
 #define CLOCKRATE (255<<13)
 #define TIC_DEFAULT_COLOR 15
 #define TIC_SOUND_RINGBUF_LEN 12 // in worst case, this induces ~ 12 tick delay i.e. 200 ms
+#define TIC_VBANKS 2
+#define TIC_TILES (TIC_BANK_SPRITES * TIC_SPRITE_BANKS)
+#define TIC_TILE_LAYOUTS 7 // a tile in RAM holds one 4bpp, two 2bpp or four 1bpp tiles
+#define TIC_RASTER_SIZE 1024
+#define TIC_MAP_CELLS (TIC_MAP_WIDTH * TIC_MAP_HEIGHT)
+#define TIC_PATH_UNREACHABLE 0xffff
+#define TIC_MAP_CHUNK_SIZE 8 // map chunk side in cells
+#define TIC_MAP_CHUNKS ((TIC_MAP_WIDTH / TIC_MAP_CHUNK_SIZE) * (TIC_MAP_HEIGHT / TIC_MAP_CHUNK_SIZE))
+#define TIC_MAP_CHUNK_SLOTS 48 // a screen of map shows 20 chunks at most
+#define TIC_HEAP_CLASSES 16 // script VM blocks up to 256 bytes are pooled in 16 byte steps
 
 typedef struct
 {
@@ -95,6 +105,25 @@ typedef struct
     s32 beat;
 } tic_jump_command;
 
+// VRAM byte written before the fullscreen row is blitted, see tic_api_raster
+typedef struct
+{
+    u8 row;
+    u8 bank;
+    u8 address; // from the start of the palette
+    u8 value;
+} tic_raster_entry;
+
+// map tile replacement, see tic_api_remap
+typedef struct
+{
+    u8 index;
+    u8 flip;
+    u8 rotate;
+    u8 frames; // tiles the replacement cycles through, 0 if the tile is drawn as it is
+    u8 ticks; // frames every tile of the cycle is shown
+} tic_remap_entry;
+
 typedef struct
 {
 
@@ -153,9 +182,28 @@ typedef struct
     struct
     {
         s32 id;
+
+        // the active vbank is kept in `mem` and the other one in RAM,
+        // switching only flips this until RAM is materialised again
+        bool swapped;
         tic_vram mem;
     } vbank;
 
+    // raster table, sorted by row
+    struct
+    {
+        s32 count;
+        tic_raster_entry entries[TIC_RASTER_SIZE];
+    } raster;
+
+    // remap table applied by map() before the remap callback
+    struct
+    {
+        s32 count;
+        u32 ticks;
+        tic_remap_entry entries[TIC_BANK_SPRITES];
+    } remap;
+
     struct ClipRect
     {
         s32 l, t, r, b;
@@ -164,6 +212,32 @@ typedef struct
     bool initialized;
 } tic_core_state_data;
 
+// map chunk unpacked to a byte per pixel with the tile colors before the mapping
+typedef struct
+{
+    s32 chunk;
+    u32 stamp;
+    bool valid;
+    u8 segment;
+
+    // remapped tiles and orientations of the cells the pixels are unpacked from,
+    // their RAM tiles and the versions of them
+    u16 cells[TIC_MAP_CHUNK_SIZE * TIC_MAP_CHUNK_SIZE];
+    u16 tiles[TIC_MAP_CHUNK_SIZE * TIC_MAP_CHUNK_SIZE];
+    u32 versions[TIC_MAP_CHUNK_SIZE * TIC_MAP_CHUNK_SIZE];
+
+    u8 data[TIC_MAP_CHUNK_SIZE * TIC_SPRITESIZE][TIC_MAP_CHUNK_SIZE * TIC_SPRITESIZE];
+} tic_map_chunk;
+
+// everything the blit of a row depends on besides the screen pixels
+typedef struct
+{
+    tic_palette palette[TIC_VBANKS];
+    u8 border;
+    u8 clear;
+    u16 offset[TIC_VBANKS];
+} tic_blit_row;
+
 typedef struct
 {
     tic_mem memory; // it should be first
@@ -182,6 +256,137 @@ typedef struct
     tic_tick_data* data;
     tic_core_state_data state;
 
+    // rasterizer scratch buffers, kept per core to make it reentrant
+    struct
+    {
+        // 1/z of the nearest pixels, single precision is plenty for the depth test
+        float zbuffer[TIC80_WIDTH * TIC80_HEIGHT];
+        u8 mapping[TIC_PALETTE_SIZE];
+
+        // ttri with depth divides the texture coords by z every this many pixels, see tic_core_perspective
+        s32 perspective;
+
+        struct
+        {
+            s16 left[TIC80_HEIGHT];
+            s16 right[TIC80_HEIGHT];
+            s32 uleft[TIC80_HEIGHT];
+            s32 vleft[TIC80_HEIGHT];
+        } sides;
+    } raster;
+
+    // dirty rows tracking, the blit redraws only rows that could have changed
+    struct
+    {
+        // screen rows of the vbanks written since they were blitted
+        bool dirty[TIC_VBANKS][TIC80_HEIGHT];
+
+        // output rows that have to be redrawn anyway
+        bool stale[TIC80_FULLHEIGHT];
+
+        tic_blit_row rows[TIC80_FULLHEIGHT];
+
+        // the vbank palettes last expanded to the screen format,
+        // vbank0 colors followed by vbank1 colors
+        struct
+        {
+            bool valid[TIC_VBANKS];
+            tic_palette src[TIC_VBANKS];
+            u32 data[TIC_PALETTE_SIZE * TIC_VBANKS];
+        } palette;
+    } blit;
+
+    // tiles and sprites RAM unpacked to a byte per pixel for every bpp layout
+    struct
+    {
+        // a bit per layout, cleared when the RAM of the tile is written
+        u8 valid[TIC_TILES];
+        u8 data[TIC_TILES][TIC_TILE_LAYOUTS][TIC_SPRITESIZE * TIC_SPRITESIZE];
+
+        // bumped when the RAM of the tile is written, the map chunks check it
+        u32 version[TIC_TILES];
+    } tiles;
+
+    // map chunks unpacked to a byte per pixel for map() calls without remap,
+    // the cells are checked against the map and tiles RAM once per call, see drawMap
+    struct
+    {
+        // drawMap calls so far, a slot is checked once per call
+        u32 stamp;
+
+        // slot of every map chunk plus one, 0 if it isn't cached
+        u8 lookup[TIC_MAP_CHUNKS];
+
+        tic_map_chunk slots[TIC_MAP_CHUNK_SLOTS];
+    } chunks;
+
+    // pathfinding buffers over the map cells, see path.c
+    struct
+    {
+        // A* search state of the cells marked with the current generation
+        u16 generation;
+        u16 mark[TIC_MAP_CELLS];
+        u16 cost[TIC_MAP_CELLS];
+        u16 from[TIC_MAP_CELLS];
+        u16 index[TIC_MAP_CELLS];
+
+        // open cells of A* or the queue of the flow field, then the found path
+        u16 queue[TIC_MAP_CELLS];
+
+        // target cell of the flow field, -1 if there is none, and the steps to it from every cell
+        s32 target;
+        u16 flow[TIC_MAP_CELLS];
+    } path;
+
+    // off-screen surface the drawing goes to while it's open, see tic_api_canvas
+    struct
+    {
+        bool open;
+
+        // top left tile and size in tiles of the sheet block it's packed to
+        s32 index, w, h;
+
+        // clip rect of the screen to restore when it's closed
+        struct ClipRect clip;
+
+        tic_screen screen;
+    } canvas;
+
+    // compiled chunk of the last code a script VM loaded, it's kept across run and reset
+    // so unchanged code skips the compiler, see tic_core_compiled
+    struct
+    {
+        const tic_script_config* script;
+        char* code;
+        void* data;
+        s32 size;
+    } compiled;
+
+    // cart bytecode is loaded unverified, so it's used only if it's signed with the key of this install
+    // or it's the bytecode of the cart the app is built with, see tic_core_bytecode_key
+    struct
+    {
+        u8 key[TIC_BYTECODE_KEY];
+        u8 trusted[TIC_BYTECODE_KEY];
+        bool keyed;
+        bool embedded;
+    } bytecode;
+
+    // size class pools the script VMs allocate from, see heap.c
+    struct
+    {
+        void* free[TIC_HEAP_CLASSES];
+        void* pages;
+    } heap;
+
+    // pacing of the script collector, see tic_core_gc
+    struct
+    {
+        s32 budget;     // microseconds per frame, 0 leaves the collection to the runtime
+        bool cycle;     // a cycle is started and not finished yet
+        u64 live;       // bytes the heap held after the last cycle
+    } gc;
+
     struct
     {
         tic_core_state_data state;   
@@ -201,12 +406,82 @@ void tic_core_tick_io(tic_mem* memory);
 void tic_core_sound_tick_start(tic_mem* memory);
 void tic_core_sound_tick_end(tic_mem* memory);
 
+// the chunk compiled from the code by the current script, NULL if it isn't cached
+const void* tic_core_compiled(tic_core* core, const char* code, s32* size);
+// caches the chunk compiled from the code by the current script, replacing the previous one
+void tic_core_compiled_set(tic_core* core, const char* code, const void* data, s32 size);
+
+// allocator of the script VMs, lua_Alloc style: the block is freed when nsize is 0,
+// returns NULL if the cart would go over its memory cap, shrinking never fails
+void* tic_core_heap_realloc(tic_core* core, void* ptr, size_t osize, size_t nsize);
+// returns the pages to the system, call it when the script VM is closed
+void tic_core_heap_reset(tic_core* core);
+
+// RAM is the core's own unless the script VM maps it (wasm), then the writes
+// bypass the dirty tracking and the caches that depend on it
+static inline bool tic_core_ram_tracked(tic_core* core)
+{
+    return core->memory.ram == core->memory.base_ram;
+}
+
+// storage of the vbank, RAM holds the active one unless the last switch is still pending
+static inline tic_vram* tic_core_vbank(tic_core* core, s32 bank)
+{
+    return (bank == core->state.vbank.id) != core->state.vbank.swapped
+        ? &core->memory.ram->vram
+        : &core->state.vbank.mem;
+}
+
+// storage of the active vbank, drawing goes there
+static inline tic_vram* tic_core_vram(tic_core* core)
+{
+    return tic_core_vbank(core, core->state.vbank.id);
+}
+
+// marks screen rows of the current vbank in the [address, address + size) RAM range as dirty
+static inline void tic_core_blit_dirty(tic_core* core, s32 address, s32 size)
+{
+    enum{RowSize = TIC80_WIDTH * TIC_PALETTE_BPP / BITS_IN_BYTE, ScreenSize = sizeof(tic_screen)};
+
+    if(address < ScreenSize)
+    {
+        bool* dirty = core->blit.dirty[core->state.vbank.id];
+        s32 last = (MIN(address + size, ScreenSize) - 1) / RowSize;
+
+        for(s32 row = address / RowSize; row <= last; ++row)
+            dirty[row] = true;
+    }
+}
+
+// drops the unpacked tiles in the [address, address + size) RAM range
+static inline void tic_core_tiles_dirty(tic_core* core, s32 address, s32 size)
+{
+    enum{Start = offsetof(tic_ram, tiles), End = Start + sizeof(tic_tile) * TIC_TILES, TileSize = sizeof(tic_tile)};
+
+    if(address < End && address + size > Start)
+    {
+        s32 last = (MIN(address + size, End) - Start - 1) / TileSize;
+
+        for(s32 tile = (MAX(address, Start) - Start) / TileSize; tile <= last; ++tile)
+        {
+            core->tiles.valid[tile] = 0;
+            core->tiles.version[tile]++;
+        }
+    }
+}
+
+// blit row kernels, see blit.c
+void tic_core_blit_unpack(const u8* src, u8* dst, s32 count);
+void tic_core_blit_merge(const u8* bank0, const u8* bank1, u8 clear, u8* dst, s32 count);
+void tic_core_blit_expand(const u8* src, const u32* pal, u32* dst, s32 count);
+
 #if defined(BUILD_DEPRECATED)
 // mouse cursor is the same in both modes
 // for backward compatibility
 #define OVR_COMPAT(CORE, BANK)                                              \
     tic_api_vbank(&CORE->memory, BANK),                                     \
-    CORE->memory.ram->vram.vars.cursor = CORE->state.vbank.mem.vars.cursor
+    tic_core_vram(CORE)->vars.cursor =                                      \
+        tic_core_vbank(CORE, !CORE->state.vbank.id)->vars.cursor
 
 #define OVR(CORE)                                   \
     s32 MACROVAR(_bank_) = CORE->state.vbank.id;    \
@@ -33,6 +33,12 @@
 
 typedef void(*PixelFunc)(tic_mem* memory, s32 x, s32 y, u8 color);
 
+// the segments 0 and 1 are read from the font RAM, the rest from the tiles and sprites RAM
+static inline bool isFontSegment(u8 segment)
+{
+    return segment < 2;
+}
+
 static tic_tilesheet getTileSheetFromSegment(tic_mem* memory, u8 segment)
 {
     u8* src;
@@ -49,37 +55,43 @@ static tic_tilesheet getTileSheetFromSegment(tic_mem* memory, u8 segment)
 
 static u8* getPalette(tic_mem* tic, u8* colors, u8 count)
 {
-    static u8 mapping[TIC_PALETTE_SIZE];
-    for (s32 i = 0; i < TIC_PALETTE_SIZE; i++) mapping[i] = tic_tool_peek4(tic->ram->vram.mapping, i);
-    for (s32 i = 0; i < count; i++) mapping[colors[i]] = TRANSPARENT_COLOR;
+    u8* mapping = ((tic_core*)tic)->raster.mapping;
+    for (s32 i = 0; i < TIC_PALETTE_SIZE; i++) mapping[i] = tic_tool_peek4(tic_core_vram((tic_core*)tic)->mapping, i);
+    for (s32 i = 0; i < count; i++) mapping[colors[i] & 0xf] = TRANSPARENT_COLOR;
     return mapping;
 }
 
 static inline u8 mapColor(tic_mem* tic, u8 color)
 {
-    return tic_tool_peek4(tic->ram->vram.mapping, color & 0xf);
+    return tic_tool_peek4(tic_core_vram((tic_core*)tic)->mapping, color & 0xf);
 }
 
-static inline void setPixel(tic_core* core, s32 x, s32 y, u8 color)
+// pixels of the open canvas or of the current vbank screen
+static inline u8* getScreen(tic_core* core)
 {
-    const tic_vram* vram = &core->memory.ram->vram;
-
-    if (x < core->state.clip.l || y < core->state.clip.t || x >= core->state.clip.r || y >= core->state.clip.b) return;
+    return core->canvas.open ? core->canvas.screen.data : tic_core_vram(core)->screen.data;
+}
 
-    tic_api_poke4((tic_mem*)core, y * TIC80_WIDTH + x, color);
+// the canvas is never blitted, so only screen rows are marked
+static inline void setRowsDirty(tic_core* core, s32 y, s32 count)
+{
+    if (!core->canvas.open)
+        tic_core_blit_dirty(core, y * TIC80_WIDTH / 2, count * TIC80_WIDTH / 2);
 }
 
-static inline void setPixelFast(tic_core* core, s32 x, s32 y, u8 color)
+static inline void setPixel(tic_core* core, s32 x, s32 y, u8 color)
 {
-    // does not do any CLIP checking, the caller needs to do that first
-    tic_api_poke4((tic_mem*)core, y * TIC80_WIDTH + x, color);
+    if (x < core->state.clip.l || y < core->state.clip.t || x >= core->state.clip.r || y >= core->state.clip.b) return;
+
+    tic_tool_poke4(getScreen(core), y * TIC80_WIDTH + x, color);
+    setRowsDirty(core, y, 1);
 }
 
 static u8 getPixel(tic_core* core, s32 x, s32 y)
 {
     return x < 0 || y < 0 || x >= TIC80_WIDTH || y >= TIC80_HEIGHT
         ? 0
-        : tic_api_peek4((tic_mem*)core, y * TIC80_WIDTH + x);
+        : tic_tool_peek4(getScreen(core), y * TIC80_WIDTH + x);
 }
 
 #define EARLY_CLIP(x, y, width, height) \
@@ -92,21 +104,29 @@ static u8 getPixel(tic_core* core, s32 x, s32 y)
 
 static void drawHLine(tic_core* core, s32 x, s32 y, s32 width, u8 color)
 {
-    const tic_vram* vram = &core->memory.ram->vram;
+    u8* screen = getScreen(core);
 
     if (y < core->state.clip.t || core->state.clip.b <= y) return;
 
     s32 xl = MAX(x, core->state.clip.l);
     s32 xr = MIN(x + width, core->state.clip.r);
-    s32 start = y * TIC80_WIDTH;
 
-    for(s32 i = start + xl, end = start + xr; i < end; ++i)
-        tic_api_poke4((tic_mem*)core, i, color);
+    if (xl >= xr) return;
+
+    // odd ends are poked, the pixel pairs between them are filled by bytes
+    s32 start = y * TIC80_WIDTH + xl;
+    s32 end = y * TIC80_WIDTH + xr;
+
+    if (start & 1) tic_tool_poke4(screen, start++, color);
+    if (end & 1) tic_tool_poke4(screen, --end, color);
+
+    memset(screen + start / 2, (color & 0xf) | (color << TIC_PALETTE_BPP), (end - start) / 2);
+    setRowsDirty(core, y, 1);
 }
 
 static void drawVLine(tic_core* core, s32 x, s32 y, s32 height, u8 color)
 {
-    const tic_vram* vram = &core->memory.ram->vram;
+    const tic_vram* vram = tic_core_vram(core);
 
     if (x < core->state.clip.l || core->state.clip.r <= x) return;
 
@@ -132,79 +152,214 @@ static void drawRectBorder(tic_core* core, s32 x, s32 y, s32 width, s32 height,
     drawVLine(core, x + width - 1, y, height, color);
 }
 
-#define DRAW_TILE_BODY(X, Y) do {\
-    for(s32 py=sy; py < ey; py++, y++) \
+// writes a row of mapped colors to the screen skipping the transparent ones,
+// the caller has to clip it
+static void drawTileRow(tic_core* core, s32 x, s32 y, const u8* colors, s32 count)
+{
+    if (count <= 0) return;
+
+    u8* screen = getScreen(core);
+    s32 pixel = y * TIC80_WIDTH + x;
+    s32 i = 0;
+
+    if (pixel & 1)
+    {
+        if (colors[i] != TRANSPARENT_COLOR) tic_tool_poke4(screen, pixel, colors[i]);
+        i++, pixel++;
+    }
+
+    for (; i + 1 < count; i += 2, pixel += 2)
+    {
+        u8 c0 = colors[i], c1 = colors[i + 1];
+
+        if (c0 != TRANSPARENT_COLOR && c1 != TRANSPARENT_COLOR)
+            screen[pixel / 2] = c0 | (c1 << TIC_PALETTE_BPP);
+        else
+        {
+            if (c0 != TRANSPARENT_COLOR) tic_tool_poke4(screen, pixel, c0);
+            if (c1 != TRANSPARENT_COLOR) tic_tool_poke4(screen, pixel + 1, c1);
+        }
+    }
+
+    if (i < count && colors[i] != TRANSPARENT_COLOR)
+        tic_tool_poke4(screen, pixel, colors[i]);
+
+    setRowsDirty(core, y, 1);
+}
+
+typedef u8 TileData[TIC_SPRITESIZE][TIC_SPRITESIZE];
+
+// unpacks the tile rows to mapped colors, a row is 1, 2 or 4 bytes
+#define UNPACK_TILE(BPP) \
+    for (s32 y = 0; y < TIC_SPRITESIZE; y++, src += pitch) \
     { \
-        s32 xx = x; \
-        for(s32 px=sx; px < ex; px++, xx++) \
-        { \
-            u8 color = mapping[tic_tilesheet_gettilepix(tile, (X), (Y))];\
-            if(color != TRANSPARENT_COLOR) setPixelFast(core, xx, y, color); \
-        } \
-    } \
-    } while(0)
+        u32 row = 0; \
+        for (s32 i = 0; i < (BPP); i++) row |= (u32)src[i] << (i * BITS_IN_BYTE); \
+        for (s32 x = 0; x < TIC_SPRITESIZE; x++, row >>= (BPP)) \
+            *dst++ = mapping[row & ((1 << (BPP)) - 1)]; \
+    }
 
-#define REVERT(X) (TIC_SPRITESIZE - 1 - (X))
+static void unpackTile(const tic_tileptr* tile, const u8* mapping, u8* dst)
+{
+    u32 bpp = tic_tilesheet_bpp(tile->segment);
+    u32 pitch = tile->segment->tile_width * bpp / BITS_IN_BYTE;
+    const u8* src = tile->ptr + tile->offset * bpp / BITS_IN_BYTE;
+
+    switch (bpp)
+    {
+    case 1: UNPACK_TILE(1); break;
+    case 2: UNPACK_TILE(2); break;
+    case 4: UNPACK_TILE(4); break;
+    }
+}
+
+#undef UNPACK_TILE
 
-static void drawTile(tic_core* core, tic_tileptr* tile, s32 x, s32 y, u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
+static const u8 IdentityMapping[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+// unpacked pixels of a tile from the tiles and sprites RAM, kept until the RAM is written,
+// returns NULL for the font tiles and when RAM is owned by the script VM (wasm)
+static const u8* getTileTexels(tic_core* core, const tic_tileptr* tile)
 {
-    const tic_vram* vram = &core->memory.ram->vram;
-    u8* mapping = getPalette(&core->memory, colors, count);
+    const u8* base = (const u8*)core->memory.ram->tiles.data;
 
-    rotate &= 3;
-    u32 orientation = flip & 3;
+    if (!tic_core_ram_tracked(core)
+        || tile->ptr < base || tile->ptr >= base + sizeof(tic_tile) * TIC_TILES)
+        return NULL;
 
-    if (rotate == tic_90_rotate) orientation ^= 1;
-    else if (rotate == tic_180_rotate) orientation ^= 3;
-    else if (rotate == tic_270_rotate) orientation ^= 2;
-    if (rotate == tic_90_rotate || rotate == tic_270_rotate) orientation |= 4;
+    s32 index = (s32)(tile->ptr - base) / sizeof(tic_tile);
+    s32 layout = TIC_PALETTE_BPP / tic_tilesheet_bpp(tile->segment) - 1 + tile->offset / TIC_SPRITESIZE;
+    u8* texels = core->tiles.data[index][layout];
 
+    if (core->tiles.valid[index] & (1 << layout))
+    {
+        core->memory.stats.tiles.hits++;
+    }
+    else
+    {
+        unpackTile(tile, IdentityMapping, texels);
+        core->tiles.valid[index] |= 1 << layout;
+        core->memory.stats.tiles.misses++;
+    }
+
+    return texels;
+}
+
+static void decodeTile(tic_core* core, const tic_tileptr* tile, const u8* mapping, TileData dst)
+{
+    const u8* texels = getTileTexels(core, tile);
+
+    if (!texels)
+    {
+        unpackTile(tile, mapping, (u8*)dst);
+        return;
+    }
+
+    for (s32 y = 0; y < TIC_SPRITESIZE; y++, texels += TIC_SPRITESIZE)
+        for (s32 x = 0; x < TIC_SPRITESIZE; x++)
+            dst[y][x] = mapping[texels[x]];
+}
+
+#define ORIENT_TILE(X, Y) \
+    for (s32 py = 0; py < TIC_SPRITESIZE; py++) \
+        for (s32 px = 0; px < TIC_SPRITESIZE; px++) \
+            dst[py][px] = src[Y][X]
+
+#define REVERT(X) (TIC_SPRITESIZE - 1 - (X))
+
+static void orientTile(TileData src, u32 orientation, TileData dst)
+{
+    switch (orientation) {
+    case 4: ORIENT_TILE(py, px); break;
+    case 6: ORIENT_TILE(REVERT(py), px); break;
+    case 5: ORIENT_TILE(py, REVERT(px)); break;
+    case 7: ORIENT_TILE(REVERT(py), REVERT(px)); break;
+    case 2: ORIENT_TILE(px, REVERT(py)); break;
+    case 1: ORIENT_TILE(REVERT(px), py); break;
+    case 3: ORIENT_TILE(REVERT(px), REVERT(py)); break;
+    }
+}
+
+#undef ORIENT_TILE
+#undef REVERT
+
+// draws the [start, end) columns of the decoded tile at x, y
+static void drawTileData(tic_core* core, TileData data, s32 x, s32 y, s32 start, s32 end, s32 scale)
+{
     if (scale == 1) {
         // the most common path
-        s32 sx, sy, ex, ey;
-        sx = core->state.clip.l - x; if (sx < 0) sx = 0;
-        sy = core->state.clip.t - y; if (sy < 0) sy = 0;
-        ex = core->state.clip.r - x; if (ex > TIC_SPRITESIZE) ex = TIC_SPRITESIZE;
-        ey = core->state.clip.b - y; if (ey > TIC_SPRITESIZE) ey = TIC_SPRITESIZE;
-        y += sy;
-        x += sx;
-        switch (orientation) {
-        case 4: DRAW_TILE_BODY(py, px); break;
-        case 6: DRAW_TILE_BODY(REVERT(py), px); break;
-        case 5: DRAW_TILE_BODY(py, REVERT(px)); break;
-        case 7: DRAW_TILE_BODY(REVERT(py), REVERT(px)); break;
-        case 0: DRAW_TILE_BODY(px, py); break;
-        case 2: DRAW_TILE_BODY(px, REVERT(py)); break;
-        case 1: DRAW_TILE_BODY(REVERT(px), py); break;
-        case 3: DRAW_TILE_BODY(REVERT(px), REVERT(py)); break;
-        }
+        s32 sx = MAX(start, core->state.clip.l - x);
+        s32 ex = MIN(end, core->state.clip.r - x);
+        s32 sy = MAX(0, core->state.clip.t - y);
+        s32 ey = MIN(TIC_SPRITESIZE, core->state.clip.b - y);
+
+        for (s32 py = sy; py < ey; py++)
+            drawTileRow(core, x + sx, y + py, data[py] + sx, ex - sx);
+
         return;
     }
 
-    if (EARLY_CLIP(x, y, TIC_SPRITESIZE * scale, TIC_SPRITESIZE * scale)) return;
+    s32 xl = MAX(x + start * scale, core->state.clip.l);
+    s32 xr = MIN(x + end * scale, core->state.clip.r);
+
+    if (xl >= xr) return;
 
-    for (s32 py = 0; py < TIC_SPRITESIZE; py++, y += scale)
+    u8 line[TIC80_WIDTH];
+
+    for (s32 py = 0; py < TIC_SPRITESIZE; py++)
     {
-        s32 xx = x;
-        for (s32 px = 0; px < TIC_SPRITESIZE; px++, xx += scale)
+        s32 yl = MAX(y + py * scale, core->state.clip.t);
+        s32 yr = MIN(y + (py + 1) * scale, core->state.clip.b);
+
+        if (yl >= yr) continue;
+
+        // the texel row stretched to the clipped span, then drawn on every line
+        s32 px = (xl - x) / scale;
+        for (s32 xx = xl, next = x + (px + 1) * scale; xx < xr; xx++)
         {
-            s32 ix = orientation & 1 ? TIC_SPRITESIZE - px - 1 : px;
-            s32 iy = orientation & 2 ? TIC_SPRITESIZE - py - 1 : py;
-            if (orientation & 4) {
-                s32 tmp = ix; ix = iy; iy = tmp;
-            }
-            u8 color = mapping[tic_tilesheet_gettilepix(tile, ix, iy)];
-            if (color != TRANSPARENT_COLOR) drawRect(core, xx, y, scale, scale, color);
+            if (xx == next) px++, next += scale;
+            line[xx - xl] = data[py][px];
         }
+
+        for (s32 yy = yl; yy < yr; yy++)
+            drawTileRow(core, xl, yy, line, xr - xl);
     }
 }
 
-#undef DRAW_TILE_BODY
-#undef REVERT
+// flip and rotation as one of the orientTile transforms
+static u32 getOrientation(tic_flip flip, tic_rotate rotate)
+{
+    rotate &= 3;
+    u32 orientation = flip & 3;
+
+    if (rotate == tic_90_rotate) orientation ^= 1;
+    else if (rotate == tic_180_rotate) orientation ^= 3;
+    else if (rotate == tic_270_rotate) orientation ^= 2;
+    if (rotate == tic_90_rotate || rotate == tic_270_rotate) orientation |= 4;
+
+    return orientation;
+}
+
+static void drawTile(tic_core* core, tic_tileptr* tile, s32 x, s32 y, const u8* mapping, s32 scale, tic_flip flip, tic_rotate rotate)
+{
+    u32 orientation = getOrientation(flip, rotate);
+
+    if (scale != 1 && EARLY_CLIP(x, y, TIC_SPRITESIZE * scale, TIC_SPRITESIZE * scale)) return;
+
+    TileData data, oriented;
+    decodeTile(core, tile, mapping, data);
+
+    if (orientation)
+    {
+        orientTile(data, orientation, oriented);
+        drawTileData(core, oriented, x, y, 0, TIC_SPRITESIZE, scale);
+    }
+    else drawTileData(core, data, x, y, 0, TIC_SPRITESIZE, scale);
+}
 
 static void drawSprite(tic_core* core, s32 index, s32 x, s32 y, s32 w, s32 h, u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
 {
-    const tic_vram* vram = &core->memory.ram->vram;
+    const tic_vram* vram = tic_core_vram(core);
 
     if (index < 0)
         return;
@@ -212,10 +367,12 @@ static void drawSprite(tic_core* core, s32 index, s32 x, s32 y, s32 w, s32 h, u8
     rotate &= 3;
     flip &= 3;
 
-    tic_tilesheet sheet = getTileSheetFromSegment(&core->memory, core->memory.ram->vram.blit.segment);
+    tic_tilesheet sheet = getTileSheetFromSegment(&core->memory, tic_core_vram(core)->blit.segment);
+    const u8* mapping = getPalette(&core->memory, colors, count);
+
     if (w == 1 && h == 1) {
         tic_tileptr tile = tic_tilesheet_gettile(&sheet, index, false);
-        drawTile(core, &tile, x, y, colors, count, scale, flip, rotate);
+        drawTile(core, &tile, x, y, mapping, scale, flip, rotate);
     }
     else
     {
@@ -257,19 +414,207 @@ static void drawSprite(tic_core* core, s32 index, s32 x, s32 y, s32 w, s32 h, u8
 
                 tic_tileptr tile = tic_tilesheet_gettile(&sheet, index + mx + my * cols, false);
                 if (rotate == 0 || rotate == 2)
-                    drawTile(core, &tile, x + i * step, y + j * step, colors, count, scale, flip, rotate);
+                    drawTile(core, &tile, x + i * step, y + j * step, mapping, scale, flip, rotate);
                 else
-                    drawTile(core, &tile, x + j * step, y + i * step, colors, count, scale, flip, rotate);
+                    drawTile(core, &tile, x + j * step, y + i * step, mapping, scale, flip, rotate);
             }
         }
     }
 }
 
+// the map tile replaced by the remap table, see tic_api_remap
+static inline RemapResult remapTile(const tic_core* core, u8 value)
+{
+    RemapResult result = {value, tic_no_flip, tic_no_rotate};
+
+    if (core->state.remap.count)
+    {
+        const tic_remap_entry* entry = &core->state.remap.entries[value];
+
+        if (entry->frames)
+        {
+            result.index = entry->index + core->state.remap.ticks / entry->ticks % entry->frames;
+            result.flip = entry->flip;
+            result.rotate = entry->rotate;
+        }
+    }
+
+    return result;
+}
+
+enum
+{
+    ChunkCols = TIC_MAP_WIDTH / TIC_MAP_CHUNK_SIZE,
+    ChunkPixels = TIC_MAP_CHUNK_SIZE * TIC_SPRITESIZE,
+};
+
+// the chunk with the pixels of the current map and tiles RAM, only the cells
+// that changed since the chunk was last drawn are unpacked again
+static const tic_map_chunk* getMapChunk(tic_core* core, const tic_map* src, const tic_tilesheet* sheet, u8 segment, s32 cx, s32 cy)
+{
+    s32 chunk = cx + cy * ChunkCols;
+    s32 index = core->chunks.lookup[chunk] - 1;
+
+    if (index < 0)
+    {
+        // the least recently drawn slot is taken over
+        index = 0;
+        for (s32 i = 1; i < TIC_MAP_CHUNK_SLOTS; i++)
+            if (core->chunks.slots[i].stamp < core->chunks.slots[index].stamp)
+                index = i;
+
+        tic_map_chunk* slot = &core->chunks.slots[index];
+
+        if (core->chunks.lookup[slot->chunk] == index + 1)
+            core->chunks.lookup[slot->chunk] = 0;
+
+        core->chunks.lookup[chunk] = index + 1;
+        slot->chunk = chunk;
+        slot->valid = false;
+    }
+
+    tic_map_chunk* slot = &core->chunks.slots[index];
+
+    if (slot->stamp == core->chunks.stamp)
+        return slot;
+
+    const u8* base = (const u8*)core->memory.ram->tiles.data;
+    bool valid = slot->valid && slot->segment == segment;
+
+    slot->stamp = core->chunks.stamp;
+    slot->segment = segment;
+    slot->valid = true;
+
+    for (s32 j = 0, cell = 0; j < TIC_MAP_CHUNK_SIZE; j++)
+    {
+        const u8* row = src->data + cx * TIC_MAP_CHUNK_SIZE + (cy * TIC_MAP_CHUNK_SIZE + j) * TIC_MAP_WIDTH;
+
+        for (s32 i = 0; i < TIC_MAP_CHUNK_SIZE; i++, cell++)
+        {
+            RemapResult retile = remapTile(core, row[i]);
+            u32 orientation = getOrientation(retile.flip, retile.rotate);
+            u16 key = retile.index | orientation << BITS_IN_BYTE;
+
+            if (valid && slot->cells[cell] == key
+                && slot->versions[cell] == core->tiles.version[slot->tiles[cell]])
+            {
+                core->memory.stats.map.hits++;
+                continue;
+            }
+
+            tic_tileptr tile = tic_tilesheet_gettile(sheet, retile.index, true);
+            TileData texels, oriented;
+            decodeTile(core, &tile, IdentityMapping, texels);
+
+            if (orientation)
+            {
+                orientTile(texels, orientation, oriented);
+                memcpy(texels, oriented, sizeof texels);
+            }
+
+            // a tile outside the tracked RAM can't be checked, so the whole chunk is unpacked next time
+            s32 offset = 0;
+
+            if (tile.ptr >= base && tile.ptr < base + sizeof(tic_tile) * TIC_TILES)
+                offset = (s32)((tile.ptr - base) / sizeof(tic_tile));
+            else slot->valid = false;
+
+            slot->cells[cell] = key;
+            slot->tiles[cell] = offset;
+            slot->versions[cell] = core->tiles.version[offset];
+
+            for (s32 py = 0; py < TIC_SPRITESIZE; py++)
+                memcpy(&slot->data[j * TIC_SPRITESIZE + py][i * TIC_SPRITESIZE], texels[py], TIC_SPRITESIZE);
+
+            core->memory.stats.map.misses++;
+        }
+    }
+
+    return slot;
+}
+
+// the map repeats in both directions
+static inline s32 wrapCell(s32 value, s32 size)
+{
+    value %= size;
+    return value < 0 ? value + size : value;
+}
+
+// draws the map at scale 1 without remap from the unpacked chunks, a screen row at a time
+static void drawMapChunks(tic_core* core, const tic_map* src, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, const u8* mapping)
+{
+    enum{MaxCols = TIC80_WIDTH / TIC_SPRITESIZE + 2};
+
+    const struct ClipRect* clip = &core->state.clip;
+    u8 segment = tic_core_vram(core)->blit.segment;
+    tic_tilesheet sheet = getTileSheetFromSegment(&core->memory, segment);
+
+    const u8* cols[MaxCols];
+    u8 line[MaxCols * TIC_SPRITESIZE];
+
+    core->chunks.stamp++;
+
+    for (s32 j = 0, top = sy; j < height; j++, top += TIC_SPRITESIZE)
+    {
+        s32 yl = MAX(top, clip->t);
+        s32 yr = MIN(top + TIC_SPRITESIZE, clip->b);
+
+        if (yl >= yr) continue;
+
+        s32 mj = wrapCell(y + j, TIC_MAP_HEIGHT);
+        s32 first = 0, count = 0;
+
+        // texels of the cells that hit the clip rect
+        for (s32 i = 0, left = sx; i < width; i++, left += TIC_SPRITESIZE)
+        {
+            if (left + TIC_SPRITESIZE <= clip->l || left >= clip->r) continue;
+
+            s32 mi = wrapCell(x + i, TIC_MAP_WIDTH);
+            const tic_map_chunk* chunk = getMapChunk(core, src, &sheet, segment,
+                mi / TIC_MAP_CHUNK_SIZE, mj / TIC_MAP_CHUNK_SIZE);
+
+            if (count == 0) first = left;
+
+            cols[count++] = &chunk->data[mj % TIC_MAP_CHUNK_SIZE * TIC_SPRITESIZE][mi % TIC_MAP_CHUNK_SIZE * TIC_SPRITESIZE];
+        }
+
+        if (count == 0) continue;
+
+        s32 xl = MAX(first, clip->l);
+        s32 xr = MIN(first + count * TIC_SPRITESIZE, clip->r);
+
+        for (s32 yy = yl; yy < yr; yy++)
+        {
+            s32 offset = (yy - top) * ChunkPixels;
+
+            for (s32 c = 0; c < count; c++)
+            {
+                const u8* texels = cols[c] + offset;
+                u8* dst = line + c * TIC_SPRITESIZE;
+
+                for (s32 px = 0; px < TIC_SPRITESIZE; px++)
+                    dst[px] = mapping[texels[px]];
+            }
+
+            drawTileRow(core, xl, yy, line + xl - first, xr - xl);
+        }
+    }
+}
+
 static void drawMap(tic_core* core, const tic_map* src, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, u8* colors, s32 count, s32 scale, RemapFunc remap, void* data)
 {
     const s32 size = TIC_SPRITESIZE * scale;
+    const u8* mapping = getPalette(&core->memory, colors, count);
 
-    tic_tilesheet sheet = getTileSheetFromSegment(&core->memory, core->memory.ram->vram.blit.segment);
+    // the chunks follow the map and tiles RAM writes, so they serve neither the font nor another map
+    if (scale == 1 && !remap && src == &core->memory.ram->map && tic_core_ram_tracked(core)
+        && !isFontSegment(tic_core_vram(core)->blit.segment))
+    {
+        drawMapChunks(core, src, x, y, width, height, sx, sy, mapping);
+        return;
+    }
+
+    tic_tilesheet sheet = getTileSheetFromSegment(&core->memory, tic_core_vram(core)->blit.segment);
 
     for (s32 j = y, jj = sy; j < y + height; j++, jj += size)
         for (s32 i = x, ii = sx; i < x + width; i++, ii += size)
@@ -283,33 +628,34 @@ static void drawMap(tic_core* core, const tic_map* src, s32 x, s32 y, s32 width,
             while (mj >= TIC_MAP_HEIGHT) mj -= TIC_MAP_HEIGHT;
 
             s32 index = mi + mj * TIC_MAP_WIDTH;
-            RemapResult retile = { *(src->data + index), tic_no_flip, tic_no_rotate };
+            RemapResult retile = remapTile(core, *(src->data + index));
 
             if (remap)
                 remap(data, mi, mj, &retile);
 
             tic_tileptr tile = tic_tilesheet_gettile(&sheet, retile.index, true);
-            drawTile(core, &tile, ii, jj, colors, count, scale, retile.flip, retile.rotate);
+            drawTile(core, &tile, ii, jj, mapping, scale, retile.flip, retile.rotate);
         }
 }
 
 static s32 drawChar(tic_core* core, tic_tileptr* font_char, s32 x, s32 y, s32 scale, bool fixed, u8* mapping)
 {
-    const tic_vram* vram = &core->memory.ram->vram;
-
     enum { Size = TIC_SPRITESIZE };
 
+    TileData data;
+    decodeTile(core, font_char, mapping, data);
+
     s32 j = 0, start = 0, end = Size;
 
     if (!fixed) {
         for (s32 i = 0; i < Size; i++) {
             for (j = 0; j < Size; j++)
-                if (mapping[tic_tilesheet_gettilepix(font_char, i, j)] != TRANSPARENT_COLOR) break;
+                if (data[j][i] != TRANSPARENT_COLOR) break;
             if (j < Size) break; else start++;
         }
         for (s32 i = Size - 1; i >= start; i--) {
             for (j = 0; j < Size; j++)
-                if (mapping[tic_tilesheet_gettilepix(font_char, i, j)] != TRANSPARENT_COLOR) break;
+                if (data[j][i] != TRANSPARENT_COLOR) break;
             if (j < Size) break; else end--;
         }
     }
@@ -317,17 +663,8 @@ static s32 drawChar(tic_core* core, tic_tileptr* font_char, s32 x, s32 y, s32 sc
 
     if (EARLY_CLIP(x, y, Size * scale, Size * scale)) return width;
 
-    s32 colStart = start, colStep = 1, rowStart = 0, rowStep = 1;
+    drawTileData(core, data, x - start * scale, y, start, end, scale);
 
-    for (s32 i = 0, col = colStart, xs = x; i < width; i++, col += colStep, xs += scale)
-    {
-        for (s32 j = 0, row = rowStart, ys = y; j < Size; j++, row += rowStep, ys += scale)
-        {
-            u8 color = tic_tilesheet_gettilepix(font_char, col, row);
-            if (mapping[color] != TRANSPARENT_COLOR)
-                drawRect(core, xs, ys, scale, scale, mapping[color]);
-        }
-    }
     return width;
 }
 
@@ -360,7 +697,7 @@ static s32 drawText(tic_core* core, tic_tilesheet* font_face, const char* text,
 void tic_api_clip(tic_mem* memory, s32 x, s32 y, s32 width, s32 height)
 {
     tic_core* core = (tic_core*)memory;
-    tic_vram* vram = &memory->ram->vram;
+    tic_vram* vram = tic_core_vram((tic_core*)memory);
 
     core->state.clip.l = x;
     core->state.clip.t = y;
@@ -371,6 +708,69 @@ void tic_api_clip(tic_mem* memory, s32 x, s32 y, s32 width, s32 height)
     if (core->state.clip.t < 0) core->state.clip.t = 0;
     if (core->state.clip.r > TIC80_WIDTH) core->state.clip.r = TIC80_WIDTH;
     if (core->state.clip.b > TIC80_HEIGHT) core->state.clip.b = TIC80_HEIGHT;
+
+    if (core->canvas.open)
+    {
+        core->state.clip.r = MIN(core->state.clip.r, core->canvas.w * TIC_SPRITESIZE);
+        core->state.clip.b = MIN(core->state.clip.b, core->canvas.h * TIC_SPRITESIZE);
+    }
+}
+
+// packs the canvas pixels to its block of the tile sheet
+static void closeCanvas(tic_core* core)
+{
+    enum{RowSize = TIC_SPRITESIZE * TIC_PALETTE_BPP / BITS_IN_BYTE};
+
+    tic_tile* tiles = core->memory.ram->tiles.data;
+
+    for (s32 j = 0; j < core->canvas.h; j++)
+        for (s32 i = 0; i < core->canvas.w; i++)
+        {
+            s32 index = core->canvas.index + i + j * TIC_SPRITESHEET_COLS;
+            const u8* src = core->canvas.screen.data + (j * TIC_SPRITESIZE * TIC80_WIDTH + i * TIC_SPRITESIZE) / 2;
+
+            for (s32 y = 0; y < TIC_SPRITESIZE; y++, src += TIC80_WIDTH / 2)
+                memcpy(tiles[index].data + y * RowSize, src, RowSize);
+
+            tic_core_tiles_dirty(core, offsetof(tic_ram, tiles) + index * sizeof(tic_tile), sizeof(tic_tile));
+        }
+
+    core->canvas.open = false;
+    core->state.clip = core->canvas.clip;
+}
+
+bool tic_api_canvas(tic_mem* memory, s32 index, s32 w, s32 h)
+{
+    tic_core* core = (tic_core*)memory;
+
+    if (core->canvas.open)
+        closeCanvas(core);
+
+    if (index < 0)
+        return true;
+
+    // the block has to fit the sheet and the surface
+    enum{Rows = TIC_TILES / TIC_SPRITESHEET_COLS, MaxRows = TIC80_HEIGHT / TIC_SPRITESIZE};
+
+    s32 col = index % TIC_SPRITESHEET_COLS, row = index / TIC_SPRITESHEET_COLS;
+
+    if (w < 1 || h < 1 || h > MaxRows || col + w > TIC_SPRITESHEET_COLS || row + h > Rows)
+        return false;
+
+    core->canvas.open = true;
+    core->canvas.index = index;
+    core->canvas.w = w;
+    core->canvas.h = h;
+    core->canvas.clip = core->state.clip;
+
+    // the block is overwritten as a whole, it starts blank
+    ZEROMEM(core->canvas.screen);
+
+    core->state.clip.l = core->state.clip.t = 0;
+    core->state.clip.r = w * TIC_SPRITESIZE;
+    core->state.clip.b = h * TIC_SPRITESIZE;
+
+    return true;
 }
 
 void tic_api_rect(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, u8 color)
@@ -380,30 +780,39 @@ void tic_api_rect(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, u8 color
     drawRect(core, x, y, width, height, mapColor(memory, color));
 }
 
-static double ZBuffer[TIC80_WIDTH * TIC80_HEIGHT];
-
 void tic_api_cls(tic_mem* tic, u8 color)
 {
     tic_core* core = (tic_core*)tic;
-    tic_vram* vram = &tic->ram->vram;
+    u8* screen = getScreen(core);
 
     static const struct ClipRect EmptyClip = { 0, 0, TIC80_WIDTH, TIC80_HEIGHT };
 
     color = mapColor(tic, color);
 
+    // the depth buffer belongs to the screen, clearing the canvas leaves it alone
+    bool depth = !core->canvas.open;
+
     if (MEMCMP(core->state.clip, EmptyClip))
     {
-        memset(&vram->screen, (color & 0xf) | (color << TIC_PALETTE_BPP), sizeof(tic_screen));
-        ZEROMEM(ZBuffer);
+        memset(screen, (color & 0xf) | (color << TIC_PALETTE_BPP), sizeof(tic_screen));
+        setRowsDirty(core, 0, TIC80_HEIGHT);
+
+        if (depth)
+            ZEROMEM(core->raster.zbuffer);
     }
     else
     {
         for(s32 y = core->state.clip.t, start = y * TIC80_WIDTH; y < core->state.clip.b; ++y, start += TIC80_WIDTH)
             for(s32 x = core->state.clip.l, pixel = start + x; x < core->state.clip.r; ++x, ++pixel)
             {
-                tic_api_poke4(tic, pixel, color);
-                ZBuffer[pixel] = 0;
+                tic_tool_poke4(screen, pixel, color);
+
+                if (depth)
+                    core->raster.zbuffer[pixel] = 0;
             }
+
+        if (core->state.clip.t < core->state.clip.b)
+            setRowsDirty(core, core->state.clip.t, core->state.clip.b - core->state.clip.t);
     }
 }
 
@@ -413,10 +822,10 @@ s32 tic_api_font(tic_mem* memory, const char* text, s32 x, s32 y, u8* trans_colo
 
     // Compatibility : flip top and bottom of the spritesheet
     // to preserve tic_api_font's default target
-    u8 segment = memory->ram->vram.blit.segment >> 1;
+    u8 segment = tic_core_vram((tic_core*)memory)->blit.segment >> 1;
     u8 flipmask = 1; while (segment >>= 1) flipmask <<= 1;
 
-    tic_tilesheet font_face = getTileSheetFromSegment(memory, memory->ram->vram.blit.segment ^ flipmask);
+    tic_tilesheet font_face = getTileSheetFromSegment(memory, tic_core_vram((tic_core*)memory)->blit.segment ^ flipmask);
     return drawText((tic_core*)memory, &font_face, text, x, y, w, h, fixed, mapping, scale, alt);
 }
 
@@ -438,26 +847,25 @@ void tic_api_spr(tic_mem* memory, s32 index, s32 x, s32 y, s32 w, s32 h, u8* tra
     drawSprite((tic_core*)memory, index, x, y, w, h, trans_colors, trans_count, scale, flip, rotate);
 }
 
-static inline u8* getFlag(tic_mem* memory, s32 index, u8 flag)
+static inline bool isFlag(s32 index, s32 flag)
 {
-    static u8 stub = 0;
-    if (index >= TIC_FLAGS || flag >= BITS_IN_BYTE)
-        return &stub;
-
-    return memory->ram->flags.data + index;
+    return index >= 0 && index < TIC_FLAGS && flag >= 0 && flag < BITS_IN_BYTE;
 }
 
-bool tic_api_fget(tic_mem* memory, s32 index, u8 flag)
+bool tic_api_fget(tic_mem* memory, s32 index, s32 flag)
 {
-    return *getFlag(memory, index, flag) & (1 << flag);
+    return isFlag(index, flag) && (memory->ram->flags.data[index] & (1 << flag));
 }
 
-void tic_api_fset(tic_mem* memory, s32 index, u8 flag, bool value)
+void tic_api_fset(tic_mem* memory, s32 index, s32 flag, bool value)
 {
+    if (!isFlag(index, flag))
+        return;
+
     if (value)
-        *getFlag(memory, index, flag) |= (1 << flag);
+        memory->ram->flags.data[index] |= (1 << flag);
     else
-        *getFlag(memory, index, flag) &= ~(1 << flag);
+        memory->ram->flags.data[index] &= ~(1 << flag);
 }
 
 u8 tic_api_pix(tic_mem* memory, s32 x, s32 y, u8 color, bool get)
@@ -477,24 +885,18 @@ void tic_api_rectb(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, u8 colo
     drawRectBorder(core, x, y, width, height, mapColor(memory, color));
 }
 
-static struct
-{
-    s16 Left[TIC80_HEIGHT];
-    s16 Right[TIC80_HEIGHT];
-} SidesBuffer;
-
-static void initSidesBuffer()
+static void initSidesBuffer(tic_core* core)
 {
-    for (s32 i = 0; i < COUNT_OF(SidesBuffer.Left); i++)
-        SidesBuffer.Left[i] = TIC80_WIDTH, SidesBuffer.Right[i] = -1;
+    for (s32 i = 0; i < COUNT_OF(core->raster.sides.left); i++)
+        core->raster.sides.left[i] = TIC80_WIDTH, core->raster.sides.right[i] = -1;
 }
 
-static void setSidePixel(s32 x, s32 y)
+static void setSidePixel(tic_core* core, s32 x, s32 y)
 {
     if (y >= 0 && y < TIC80_HEIGHT)
     {
-        if (x < SidesBuffer.Left[y]) SidesBuffer.Left[y] = x;
-        if (x > SidesBuffer.Right[y]) SidesBuffer.Right[y] = x;
+        if (x < core->raster.sides.left[y]) core->raster.sides.left[y] = x;
+        if (x > core->raster.sides.right[y]) core->raster.sides.right[y] = x;
     }
 }
 
@@ -539,31 +941,34 @@ static void setElliPixel(tic_mem* tic, s32 x, s32 y, u8 color)
 
 static void setElliSide(tic_mem* tic, s32 x, s32 y, u8 color)
 {
-    setSidePixel(x, y);
+    setSidePixel((tic_core*)tic, x, y);
 }
 
 static void drawSidesBuffer(tic_mem* memory, s32 y0, s32 y1, u8 color)
 {
-    tic_vram* vram = &memory->ram->vram;
-
     tic_core* core = (tic_core*)memory;
+    u8* screen = getScreen(core);
+
     s32 yt = MAX(core->state.clip.t, y0);
     s32 yb = MIN(core->state.clip.b, y1 + 1);
     u8 final_color = mapColor(&core->memory, color);
     for (s32 y = yt; y < yb; y++) 
     {
-        s32 xl = MAX(SidesBuffer.Left[y], core->state.clip.l);
-        s32 xr = MIN(SidesBuffer.Right[y] + 1, core->state.clip.r);
+        s32 xl = MAX(core->raster.sides.left[y], core->state.clip.l);
+        s32 xr = MIN(core->raster.sides.right[y] + 1, core->state.clip.r);
         s32 start = y * TIC80_WIDTH;
 
         for(s32 i = start + xl, end = start + xr; i < end; ++i)
-            tic_api_poke4(memory, i, color);
+            tic_tool_poke4(screen, i, color);
+
+        if (xl < xr)
+            setRowsDirty(core, y, 1);
     }
 }
 
 void tic_api_circ(tic_mem* memory, s32 x, s32 y, s32 r, u8 color)
 {
-    initSidesBuffer();
+    initSidesBuffer((tic_core*)memory);
     drawEllipse(memory, x - r, y - r, x + r, y + r, 0, setElliSide);
     drawSidesBuffer(memory, y - r, y + r + 1, mapColor(memory, color));
 }
@@ -575,7 +980,7 @@ void tic_api_circb(tic_mem* memory, s32 x, s32 y, s32 r, u8 color)
 
 void tic_api_elli(tic_mem* memory, s32 x, s32 y, s32 a, s32 b, u8 color)
 {
-    initSidesBuffer();
+    initSidesBuffer((tic_core*)memory);
     drawEllipse(memory, x - a, y - b, x + a, y + b, 0, setElliSide);
     drawSidesBuffer(memory, y - b, y + b + 1, mapColor(memory, color));
 }
@@ -638,6 +1043,10 @@ typedef struct
     void* data;
     const Vec2* v[3];
     Vec3 w;
+
+    // weight steps along the row and the end of the span being shaded
+    const Vec2* d;
+    s32 end;
 } ShaderAttr;
 
 typedef tic_color(*PixelShader)(const ShaderAttr* a, s32 pixel);
@@ -647,7 +1056,91 @@ static inline double edgeFn(const Vec2* a, const Vec2* b, const Vec2* c)
     return (b->x - a->x) * (c->y - a->y) - (b->y - a->y) * (c->x - a->x);
 }
 
-static void drawTri(tic_mem* tic, const Vec2* v0, const Vec2* v1, const Vec2* v2, PixelShader shader, void* data)
+// pixels are sampled a bit up and left of their centers and the samples on an edge are inside,
+// so the triangles sharing an edge both draw it, tri and ttri have always covered the pixels this way
+static const double TriCenter = 0.5 - FLT_EPSILON;
+
+// the weights are summed step by step, so they may be off by this part of the largest one in the box
+static const double TriRounding = 1e-11;
+
+static inline bool triInside(const Vec3* w)
+{
+    return w->x > -DBL_EPSILON && w->y > -DBL_EPSILON && w->z > -DBL_EPSILON;
+}
+
+// the weights of the k-th pixel of the row starting with s
+static inline Vec3 triWeights(const Vec3* s, const Vec2* d, s32 k)
+{
+    Vec3 w;
+
+    for(s32 i = 0; i != COUNT_OF(w.d); ++i)
+        w.d[i] = s->d[i] + k * d[i].x;
+
+    return w;
+}
+
+// narrows [xl, xr) to the pixels of the row whose samples are on the inner side of the a-b edge
+// or on it, d is the step of the edge weight
+static inline void triEdgeSpan(const Vec2* a, const Vec2* b, const Vec2* d, double py, s32* xl, s32* xr)
+{
+    if(d->x == 0.0)
+    {
+        if((b->x - a->x) * (py - a->y) < 0.0)
+            *xr = *xl;
+
+        return;
+    }
+
+    double cross = a->x + (b->x - a->x) * (py - a->y) / (b->y - a->y) - TriCenter;
+
+    if(d->x > 0.0)
+        *xl = (s32)MAX(*xl, MIN(ceil(cross), *xr));
+    else
+        *xr = (s32)MIN(*xr, MAX(floor(cross) + 1, *xl));
+}
+
+// checks the solved span is the one stepping the weights finds: its ends are inside and the pixels
+// around it are outside by more than the rounding, the weights are linear along the row so the rest
+// of it follows, the empty spans are left to stepping
+static inline bool triSpanExact(const Vec3* s, const Vec2* d, s32 min, s32 max, s32 xl, s32 xr, double eps)
+{
+    if(xl >= xr) return false;
+
+    Vec3 l = triWeights(s, d, xl - min), r = triWeights(s, d, xr - 1 - min);
+
+    for(s32 i = 0; i != COUNT_OF(l.d); ++i)
+        if(l.d[i] < eps || r.d[i] < eps)
+            return false;
+
+    if(xl > min)
+    {
+        l = triWeights(s, d, xl - 1 - min);
+        if(l.x > -eps && l.y > -eps && l.z > -eps)
+            return false;
+    }
+
+    if(xr < max)
+    {
+        r = triWeights(s, d, xr - min);
+        if(r.x > -eps && r.y > -eps && r.z > -eps)
+            return false;
+    }
+
+    return true;
+}
+
+static inline void triStep(Vec3* w, const Vec2* d)
+{
+    for(s32 i = 0; i != COUNT_OF(w->d); ++i)
+        w->d[i] += d[i].x;
+}
+
+// draws the [xl, xr) span of the row, a->w holds the weights of the xl pixel
+typedef void(*SpanFunc)(tic_core* core, ShaderAttr* a, const Vec2* d, s32 y, s32 xl, s32 xr);
+
+// the span function is a constant in every caller, so the compiler inlines it
+// into its own copy of the loop, see DRAW_TRI below
+static inline void drawTri(tic_mem* tic, const Vec2* v0, const Vec2* v1, const Vec2* v2, SpanFunc span, void* data)
 {
     ShaderAttr a = {data, v0, v1, v2};
 
@@ -674,53 +1167,81 @@ static void drawTri(tic_mem* tic, const Vec2* v0, const Vec2* v1, const Vec2* v2
 
     Vec2 d[3];
     Vec3 s;
+    double eps = 0.0;
 
     for(s32 i = 0; i != COUNT_OF(s.d); ++i)
     {
-        // pixel center
-        const double Center = 0.5 - FLT_EPSILON;
-        Vec2 p = {min.x + Center, min.y + Center};
-
+        Vec2 p = {min.x + TriCenter, min.y + TriCenter};
         s32 c = (i + 1) % 3, n = (i + 2) % 3;
-        
+
         d[i].x = (a.v[c]->y - a.v[n]->y) / area;
         d[i].y = (a.v[n]->x - a.v[c]->x) / area;
         s.d[i] = edgeFn(a.v[c], a.v[n], &p) / area;
+
+        eps = MAX(eps, fabs(s.d[i]) + fabs(d[i].x) * (max.x - min.x) + fabs(d[i].y) * (max.y - min.y));
     }
 
-    for(s32 y = min.y, start = min.y * TIC80_WIDTH + min.x; y < max.y; ++y, start += TIC80_WIDTH)
+    eps = (1.0 + eps) * TriRounding;
+
+    for(s32 y = min.y; y < max.y; ++y)
     {
-        for(s32 i = 0; i != COUNT_OF(a.w.d); ++i)
-            a.w.d[i] = s.d[i];
+        // the span is solved from the edges, the rows where a sample is too close to an edge to tell
+        // it from the summed weights are stepped pixel by pixel to cover the same pixels they always did
+        s32 xl = min.x, xr = max.x;
+
+        for(s32 i = 0; i != COUNT_OF(d) && xl < xr; ++i)
+            triEdgeSpan(a.v[(i + 1) % 3], a.v[(i + 2) % 3], &d[i], y + TriCenter, &xl, &xr);
 
-        for(s32 x = min.x, pixel = start; x < max.x; ++x, ++pixel)
+        if(triSpanExact(&s, d, min.x, max.x, xl, xr, eps))
+            a.w = triWeights(&s, d, xl - min.x);
+        else
         {
-            if(a.w.x > -DBL_EPSILON && a.w.y > -DBL_EPSILON && a.w.z > -DBL_EPSILON)
-            {
-                u8 color = shader(&a, pixel);
-                if(color != TRANSPARENT_COLOR)
-                    tic_api_poke4(tic, pixel, color);
-            }
+            Vec3 w = s;
+            s32 x = min.x;
+
+            for(; x < max.x && !triInside(&w); ++x)
+                triStep(&w, d);
 
-            for(s32 i = 0; i != COUNT_OF(a.w.d); ++i)
-                a.w.d[i] += d[i].x;
+            xl = x;
+            a.w = w;
+
+            for(; x < max.x && triInside(&w); ++x)
+                triStep(&w, d);
+
+            xr = x;
         }
 
+        if(xl < xr)
+            span(core, &a, d, y, xl, xr);
+
         for(s32 i = 0; i != COUNT_OF(s.d); ++i)
             s.d[i] += d[i].y;
     }
 }
 
-static tic_color triColorShader(const ShaderAttr* a, s32 pixel){return *(u8*)a->data;}
+typedef void(*TriFunc)(tic_mem* tic, const Vec2* v0, const Vec2* v1, const Vec2* v2, void* data);
+
+#define DRAW_TRI(NAME, SPAN)                                                                    \
+    static void NAME(tic_mem* tic, const Vec2* v0, const Vec2* v1, const Vec2* v2, void* data)  \
+    {                                                                                           \
+        drawTri(tic, v0, v1, v2, SPAN, data);                                                   \
+    }
+
+static void triColorSpan(tic_core* core, ShaderAttr* a, const Vec2* d, s32 y, s32 xl, s32 xr)
+{
+    drawHLine(core, xl, y, xr - xl, *(u8*)a->data);
+}
+
+DRAW_TRI(drawColorTri, triColorSpan)
 
 void tic_api_tri(tic_mem* tic, float x1, float y1, float x2, float y2, float x3, float y3, u8 color)
 {
     color = mapColor(tic, color);
-    drawTri(tic,
+    drawColorTri(tic,
         &(Vec2){x1, y1},
         &(Vec2){x2, y2},
         &(Vec2){x3, y3}, 
-        triColorShader, &color);
+        &color);
 }
 
 void tic_api_trib(tic_mem* tic, float x1, float y1, float x2, float y2, float x3, float y3, u8 color)
@@ -742,13 +1263,80 @@ typedef struct
 
 typedef struct
 {
+    s32 index;
+    tic_tileptr ptr;
+    const u8* texels;
+} TexTile;
+
+typedef struct
+{
+    tic_core* core;
     tic_tilesheet sheet;
     u8* mapping;
     const u8* map;
     const tic_vram* vram;
+    float* zbuffer;
     bool depth;
+
+    // perspective segment, the texture coords are divided by z at its ends
+    // and interpolated linearly between them
+    s32 perspective;
+    struct
+    {
+        s32 start, end;
+        Vec2 uv, duv;
+    } segment;
+
+    // the last sampled tile, neighbour pixels mostly sample the same one
+    TexTile tile;
 } TexData;
 
+static inline u8 getTexel(const TexTile* tile, s32 x, s32 y)
+{
+    return tile->texels
+        ? tile->texels[y * TIC_SPRITESIZE + x]
+        : tic_tilesheet_gettilepix(&tile->ptr, x, y);
+}
+
+static inline Vec2 texCoords(const ShaderAttr* a, const Vec3* w)
+{
+    Vec3 vars = {0};
+    for(s32 i = 0; i != COUNT_OF(a->v); ++i)
+    {
+        const TexVert* t = (TexVert*)a->v[i];
+        vars.x += w->d[i] * t->d.x;
+        vars.y += w->d[i] * t->d.y;
+        vars.z += w->d[i] * t->d.z;
+    }
+
+    return (Vec2){vars.x / vars.z, vars.y / vars.z};
+}
+
+static inline void texSegment(const ShaderAttr* a, TexData* data, Vec3* vars, s32 pixel)
+{
+    if(pixel >= data->segment.end)
+    {
+        s32 steps = MIN(data->perspective, a->end - 1 - pixel);
+
+        Vec3 w = a->w;
+        for(s32 i = 0; i != COUNT_OF(w.d); ++i)
+            w.d[i] += steps * a->d[i].x;
+
+        Vec2 uv = texCoords(a, &w);
+
+        data->segment.start = pixel;
+        data->segment.end = pixel + MAX(steps, 1);
+        data->segment.uv = texCoords(a, &a->w);
+        data->segment.duv = steps
+            ? (Vec2){(uv.x - data->segment.uv.x) / steps, (uv.y - data->segment.uv.y) / steps}
+            : (Vec2){0};
+    }
+
+    s32 k = pixel - data->segment.start;
+    vars->x = data->segment.uv.x + k * data->segment.duv.x;
+    vars->y = data->segment.uv.y + k * data->segment.duv.y;
+}
+
 static inline bool shaderStart(const ShaderAttr* a, Vec3* vars, s32 pixel)
 {
     TexData* data = a->data;
@@ -762,8 +1350,14 @@ static inline bool shaderStart(const ShaderAttr* a, Vec3* vars, s32 pixel)
             vars->z += a->w.d[i] * t->d.z;
         }
 
-        if(ZBuffer[pixel] < vars->z);
+        if(data->zbuffer[pixel] < (float)vars->z);
         else return false;
+
+        if(data->perspective > 1)
+        {
+            texSegment(a, data, vars, pixel);
+            return true;
+        }
     }
 
     vars->x = vars->y = 0;
@@ -786,7 +1380,7 @@ static inline tic_color shaderEnd(const ShaderAttr* a, const Vec3* vars, s32 pix
     TexData* data = a->data;
 
     if(data->depth && color != TRANSPARENT_COLOR)
-        ZBuffer[pixel] = vars->z;
+        data->zbuffer[pixel] = vars->z;
 
     return color;
 }
@@ -806,9 +1400,15 @@ static tic_color triTexMapShader(const ShaderAttr* a, s32 pixel)
     s32 iv = tic_modulo(vars.y, MapHeight);
 
     u8 idx = data->map[(iv >> 3) * TIC_MAP_WIDTH + (iu >> 3)];
-    tic_tileptr tile = tic_tilesheet_gettile(&data->sheet, idx, true);
 
-    return shaderEnd(a, &vars, pixel, data->mapping[tic_tilesheet_gettilepix(&tile, iu & WMask, iv & HMask)]);
+    if (data->tile.index != idx)
+    {
+        data->tile.index = idx;
+        data->tile.ptr = tic_tilesheet_gettile(&data->sheet, idx, true);
+        data->tile.texels = getTileTexels(data->core, &data->tile.ptr);
+    }
+
+    return shaderEnd(a, &vars, pixel, data->mapping[getTexel(&data->tile, iu & WMask, iv & HMask)]);
 }
 
 static tic_color triTexTileShader(const ShaderAttr* a, s32 pixel)
@@ -821,7 +1421,27 @@ static tic_color triTexTileShader(const ShaderAttr* a, s32 pixel)
 
     enum { WMask = TIC_SPRITESHEET_SIZE - 1, HMask = TIC_SPRITESHEET_SIZE * TIC_SPRITE_BANKS - 1 };
 
-    return shaderEnd(a, &vars, pixel, data->mapping[tic_tilesheet_getpix(&data->sheet, (s32)vars.x & WMask, (s32)vars.y & HMask)]);
+    s32 x = (s32)vars.x & WMask;
+    s32 y = (s32)vars.y & HMask;
+
+    // the same addressing as tic_tilesheet_getpix
+    const tic_blit_segment* segment = data->sheet.segment;
+    s32 col = x & (segment->tile_width - 1);
+    s32 idx = (((y >> 3) << 4) + x / segment->tile_width) * TIC_SPRITESIZE + col / TIC_SPRITESIZE;
+
+    if (data->tile.index != idx)
+    {
+        data->tile.index = idx;
+        data->tile.ptr = (tic_tileptr)
+        {
+            segment,
+            col & ~(TIC_SPRITESIZE - 1),
+            data->sheet.ptr + (idx / TIC_SPRITESIZE) * segment->ptr_size,
+        };
+        data->tile.texels = getTileTexels(data->core, &data->tile.ptr);
+    }
+
+    return shaderEnd(a, &vars, pixel, data->mapping[getTexel(&data->tile, x & (TIC_SPRITESIZE - 1), y & (TIC_SPRITESIZE - 1))]);
 }
 
 static tic_color triTexVbankShader(const ShaderAttr* a, s32 pixel)
@@ -838,6 +1458,46 @@ static tic_color triTexVbankShader(const ShaderAttr* a, s32 pixel)
     return shaderEnd(a, &vars, pixel, data->mapping[tic_tool_peek4(data->vram->data, iv * TIC80_WIDTH + iu)]);
 }
 
+// shades the span pixel by pixel, stepping the weights the same way drawTri does
+static inline void shadeSpan(tic_core* core, ShaderAttr* a, const Vec2* d, s32 y, s32 xl, s32 xr, PixelShader shader)
+{
+    u8* screen = getScreen(core);
+    bool drawn = false;
+
+    a->d = d;
+    a->end = y * TIC80_WIDTH + xr;
+
+    for(s32 pixel = y * TIC80_WIDTH + xl; pixel < a->end; ++pixel)
+    {
+        u8 color = shader(a, pixel);
+
+        if(color != TRANSPARENT_COLOR)
+        {
+            tic_tool_poke4(screen, pixel, color);
+            drawn = true;
+        }
+
+        triStep(&a->w, d);
+    }
+
+    if(drawn)
+        setRowsDirty(core, y, 1);
+}
+
+#define SHADE_SPAN(NAME, SHADER)                                                                \
+    static void NAME(tic_core* core, ShaderAttr* a, const Vec2* d, s32 y, s32 xl, s32 xr)      \
+    {                                                                                           \
+        shadeSpan(core, a, d, y, xl, xr, SHADER);                                               \
+    }
+
+SHADE_SPAN(triTexTileSpan, triTexTileShader)
+SHADE_SPAN(triTexMapSpan, triTexMapShader)
+SHADE_SPAN(triTexVbankSpan, triTexVbankShader)
+
+DRAW_TRI(drawTileTexTri, triTexTileSpan)
+DRAW_TRI(drawMapTexTri, triTexMapSpan)
+DRAW_TRI(drawVbankTexTri, triTexVbankSpan)
+
 void tic_api_ttri(tic_mem* tic, 
     float x1, float y1, 
     float x2, float y2, 
@@ -854,11 +1514,15 @@ void tic_api_ttri(tic_mem* tic,
 
     TexData texData = 
     {
-        .sheet = getTileSheetFromSegment(tic, tic->ram->vram.blit.segment),
+        .core = (tic_core*)tic,
+        .sheet = getTileSheetFromSegment(tic, tic_core_vram((tic_core*)tic)->blit.segment),
         .mapping = getPalette(tic, colors, count),
         .map = tic->ram->map.data,
-        .vram = &((tic_core*)tic)->state.vbank.mem,
+        .vram = tic_core_vbank((tic_core*)tic, !((tic_core*)tic)->state.vbank.id),
+        .zbuffer = ((tic_core*)tic)->raster.zbuffer,
         .depth = depth,
+        .perspective = ((tic_core*)tic)->raster.perspective,
+        .tile.index = -1,
     };
 
     TexVert t[] = 
@@ -874,19 +1538,19 @@ void tic_api_ttri(tic_mem* tic,
             t[i].d.y /= t[i].d.z, 
             t[i].d.z = 1.0 / t[i].d.z;
 
-    static const PixelShader Shaders[] = 
+    static const TriFunc Rasterizers[] = 
     {
-        [tic_tiles_texture] = triTexTileShader,
-        [tic_map_texture]   = triTexMapShader,
-        [tic_vbank_texture] = triTexVbankShader,
+        [tic_tiles_texture] = drawTileTexTri,
+        [tic_map_texture]   = drawMapTexTri,
+        [tic_vbank_texture] = drawVbankTexTri,
     };
     
-    if(texsrc >= 0 && texsrc < COUNT_OF(Shaders))
-        drawTri(tic,
+    if(texsrc >= 0 && texsrc < COUNT_OF(Rasterizers))
+        Rasterizers[texsrc](tic,
             (const Vec2*)&t[0],
             (const Vec2*)&t[1],
             (const Vec2*)&t[2], 
-            Shaders[texsrc], &texData);
+            &texData);
 }
 
 void tic_api_map(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, u8* colors, u8 count, s32 scale, RemapFunc remap, void* data)
@@ -894,6 +1558,42 @@ void tic_api_map(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, s32 sx, s
     drawMap((tic_core*)memory, &memory->ram->map, x, y, width, height, sx, sy, colors, count, scale, remap, data);
 }
 
+bool tic_api_remap(tic_mem* memory, s32 tile, s32 index, u8 flip, u8 rotate, s32 frames, s32 ticks)
+{
+    tic_core* core = (tic_core*)memory;
+
+    if (tile < 0)
+    {
+        ZEROMEM(core->state.remap.entries);
+        core->state.remap.count = 0;
+        return true;
+    }
+
+    if (tile >= TIC_BANK_SPRITES || index < 0 || index >= TIC_BANK_SPRITES
+        || frames < 1 || frames > UINT8_MAX || ticks < 1 || ticks > UINT8_MAX)
+        return false;
+
+    tic_remap_entry* entry = &core->state.remap.entries[tile];
+
+    if (entry->frames)
+        core->state.remap.count--;
+
+    ZEROMEM(*entry);
+
+    // the tile drawn as it is doesn't need an entry
+    if (index != tile || (flip & 3) || (rotate & 3) || frames > 1)
+    {
+        entry->index = index;
+        entry->flip = flip & 3;
+        entry->rotate = rotate & 3;
+        entry->frames = frames;
+        entry->ticks = ticks;
+        core->state.remap.count++;
+    }
+
+    return true;
+}
+
 void tic_api_mset(tic_mem* memory, s32 x, s32 y, u8 value)
 {
     if (x < 0 || x >= TIC_MAP_WIDTH || y < 0 || y >= TIC_MAP_HEIGHT) return;
@@ -910,11 +1610,204 @@ u8 tic_api_mget(tic_mem* memory, s32 x, s32 y)
     return *(src->data + y * TIC_MAP_WIDTH + x);
 }
 
+bool tic_api_mflag(tic_mem* memory, s32 x, s32 y, s32 w, s32 h, s32 flag)
+{
+    enum{Width = TIC_MAP_WIDTH * TIC_SPRITESIZE, Height = TIC_MAP_HEIGHT * TIC_SPRITESIZE};
+
+    s32 r = MIN(x + w, Width) - 1;
+    s32 b = MIN(y + h, Height) - 1;
+
+    if(w <= 0 || h <= 0 || r < 0 || b < 0 || flag < 0 || flag >= BITS_IN_BYTE)
+        return false;
+
+    const u8* map = memory->ram->map.data;
+    const u8* flags = memory->ram->flags.data;
+    const u8 mask = 1 << flag;
+
+    for(s32 j = MAX(y, 0) / TIC_SPRITESIZE, end = b / TIC_SPRITESIZE; j <= end; j++)
+    {
+        const u8* row = map + j * TIC_MAP_WIDTH;
+
+        for(s32 i = MAX(x, 0) / TIC_SPRITESIZE, last = r / TIC_SPRITESIZE; i <= last; i++)
+            if(flags[row[i]] & mask)
+                return true;
+    }
+
+    return false;
+}
+
+// Liang-Barsky clipping of the segment to the map area in pixels, false if it misses the map
+static bool clipToMap(float* x0, float* y0, float* x1, float* y1)
+{
+    const float dx = *x1 - *x0, dy = *y1 - *y0;
+    const float p[] = {-dx, dx, -dy, dy};
+    const float q[] = {*x0, TIC_MAP_WIDTH * TIC_SPRITESIZE - *x0, *y0, TIC_MAP_HEIGHT * TIC_SPRITESIZE - *y0};
+
+    float t0 = 0, t1 = 1;
+
+    for(s32 i = 0; i < COUNT_OF(p); i++)
+    {
+        if(p[i] == 0)
+        {
+            if(q[i] < 0)
+                return false;
+        }
+        else if(p[i] < 0)
+            t0 = MAX(t0, q[i] / p[i]);
+        else
+            t1 = MIN(t1, q[i] / p[i]);
+    }
+
+    if(t0 > t1)
+        return false;
+
+    const float x = *x0, y = *y0;
+
+    *x0 = x + t0 * dx;
+    *y0 = y + t0 * dy;
+    *x1 = x + t1 * dx;
+    *y1 = y + t1 * dy;
+
+    return true;
+}
+
+static inline s32 mapCell(float pos, s32 size)
+{
+    return CLAMP((s32)floorf(pos / TIC_SPRITESIZE), 0, size - 1);
+}
+
+s32 tic_api_mray(tic_mem* memory, float x0, float y0, float x1, float y1, s32 flag)
+{
+    // the cells are cast from the clipped coords, which stay finite only if the ends and the direction are
+    if(!isfinite(x0) || !isfinite(y0) || !isfinite(x1 - x0) || !isfinite(y1 - y0))
+        return -1;
+
+    if(flag < 0 || flag >= BITS_IN_BYTE || !clipToMap(&x0, &y0, &x1, &y1))
+        return -1;
+
+    const float dx = x1 - x0, dy = y1 - y0;
+    const s32 sx = dx < 0 ? -1 : 1, sy = dy < 0 ? -1 : 1;
+
+    s32 cx = mapCell(x0, TIC_MAP_WIDTH), cy = mapCell(y0, TIC_MAP_HEIGHT);
+    s32 ex = mapCell(x1, TIC_MAP_WIDTH), ey = mapCell(y1, TIC_MAP_HEIGHT);
+
+    // segment parameter at the next vertical and horizontal cell borders, and the distance between borders
+    float tx = dx ? ((cx + (sx > 0)) * TIC_SPRITESIZE - x0) / dx : FLT_MAX;
+    float ty = dy ? ((cy + (sy > 0)) * TIC_SPRITESIZE - y0) / dy : FLT_MAX;
+    const float stepx = dx ? TIC_SPRITESIZE / fabsf(dx) : FLT_MAX;
+    const float stepy = dy ? TIC_SPRITESIZE / fabsf(dy) : FLT_MAX;
+
+    const u8* map = memory->ram->map.data;
+    const u8* flags = memory->ram->flags.data;
+    const u8 mask = 1 << flag;
+
+    for(s32 n = abs(ex - cx) + abs(ey - cy); n >= 0; n--)
+    {
+        s32 cell = cx + cy * TIC_MAP_WIDTH;
+
+        if(flags[map[cell]] & mask)
+            return cell;
+
+        if(tx < ty)
+            tx += stepx, cx += sx;
+        else
+            ty += stepy, cy += sy;
+
+        if(cx < 0 || cx >= TIC_MAP_WIDTH || cy < 0 || cy >= TIC_MAP_HEIGHT)
+            break;
+    }
+
+    return -1;
+}
+
+// the tiles can be NULL to get the count of them only
+s32 tic_api_mrect(tic_mem* memory, s32 x, s32 y, s32 w, s32 h, u8* tiles)
+{
+    w = CLAMP(w, 0, TIC_MAP_WIDTH);
+    h = CLAMP(h, 0, TIC_MAP_HEIGHT);
+
+    if(tiles)
+        for(s32 j = 0; j < h; j++)
+            for(s32 i = 0; i < w; i++)
+                *tiles++ = tic_api_mget(memory, x + i, y + j);
+
+    return w * h;
+}
+
 void tic_api_line(tic_mem* memory, float x0, float y0, float x1, float y1, u8 color)
 {
     drawLine(memory, x0, y0, x1, y1, mapColor(memory, color));
 }
 
+// the commands are cast to s32, so they have to be finite and well inside its range
+static inline bool batchValid(const float* values, s32 count)
+{
+    enum{Range = 1 << 24};
+
+    for(s32 i = 0; i < count; i++)
+        if(!(fabsf(values[i]) < Range))
+            return false;
+
+    return true;
+}
+
+s32 tic_api_batch(tic_mem* memory, const float* commands, s32 count)
+{
+    static const u8 Params[] =
+    {
+#define TIC_BATCH_DEF(_, __, PARAMS) PARAMS,
+        TIC_BATCH_LIST(TIC_BATCH_DEF)
+#undef TIC_BATCH_DEF
+    };
+
+    s32 done = 0;
+
+    for(const float *cmd = commands, *end = commands + count; cmd < end; ++done)
+    {
+        if(!batchValid(cmd, 1))
+            break;
+
+        s32 op = (s32)cmd[0];
+
+        if(op < 0 || op >= COUNT_OF(Params) || end - cmd <= Params[op] || !batchValid(cmd + 1, Params[op]))
+            break;
+
+        const float* p = cmd + 1;
+        cmd = p + Params[op];
+
+        switch(op)
+        {
+        case tic_batch_pix:
+            tic_api_pix(memory, (s32)p[0], (s32)p[1], (s32)p[2], false);
+            break;
+        case tic_batch_line:
+            tic_api_line(memory, p[0], p[1], p[2], p[3], (s32)p[4]);
+            break;
+        case tic_batch_rect:
+            tic_api_rect(memory, (s32)p[0], (s32)p[1], (s32)p[2], (s32)p[3], (s32)p[4]);
+            break;
+        case tic_batch_rectb:
+            tic_api_rectb(memory, (s32)p[0], (s32)p[1], (s32)p[2], (s32)p[3], (s32)p[4]);
+            break;
+        case tic_batch_circ:
+            tic_api_circ(memory, (s32)p[0], (s32)p[1], (s32)p[2], (s32)p[3]);
+            break;
+        case tic_batch_circb:
+            tic_api_circb(memory, (s32)p[0], (s32)p[1], (s32)p[2], (s32)p[3]);
+            break;
+        case tic_batch_spr:
+            {
+                u8 colorkey = (s32)p[3] & 0xf;
+                tic_api_spr(memory, (s32)p[0], (s32)p[1], (s32)p[2], (s32)p[7], (s32)p[8],
+                    &colorkey, p[3] >= 0, (s32)p[4], (s32)p[5], (s32)p[6]);
+            }
+            break;
+        }
+    }
+
+    return done;
+}
+
 #if defined(BUILD_DEPRECATED)
 #include "draw_dep.c"
 #endif
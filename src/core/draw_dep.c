@@ -25,33 +25,25 @@ typedef struct
     float x, y, u, v;
 } TexVertDep;
 
-static struct
-{
-    s16 Left[TIC80_HEIGHT];
-    s16 Right[TIC80_HEIGHT];
-    s32 ULeft[TIC80_HEIGHT];
-    s32 VLeft[TIC80_HEIGHT];
-} SidesBufferDep;
-
-static void setSideTexPixel(s32 x, s32 y, float u, float v)
+static void setSideTexPixel(tic_core* core, s32 x, s32 y, float u, float v)
 {
     s32 yy = y;
     if (yy >= 0 && yy < TIC80_HEIGHT)
     {
-        if (x < SidesBufferDep.Left[yy])
+        if (x < core->raster.sides.left[yy])
         {
-            SidesBufferDep.Left[yy] = x;
-            SidesBufferDep.ULeft[yy] = (s32)(u * 65536.0f);
-            SidesBufferDep.VLeft[yy] = (s32)(v * 65536.0f);
+            core->raster.sides.left[yy] = x;
+            core->raster.sides.uleft[yy] = (s32)(u * 65536.0f);
+            core->raster.sides.vleft[yy] = (s32)(v * 65536.0f);
         }
-        if (x > SidesBufferDep.Right[yy])
+        if (x > core->raster.sides.right[yy])
         {
-            SidesBufferDep.Right[yy] = x;
+            core->raster.sides.right[yy] = x;
         }
     }
 }
 
-static void ticTexLine(tic_mem* memory, TexVertDep* v0, TexVertDep* v1)
+static void ticTexLine(tic_core* core, TexVertDep* v0, TexVertDep* v1)
 {
     TexVertDep* top = v0;
     TexVertDep* bot = v1;
@@ -96,7 +88,7 @@ static void ticTexLine(tic_mem* memory, TexVertDep* v0, TexVertDep* v1)
 
     for (; y < botY; ++y)
     {
-        setSideTexPixel((s32)x, (s32)y, u, v);
+        setSideTexPixel(core, (s32)x, (s32)y, u, v);
         x += step_x;
         u += step_u;
         v += step_v;
@@ -106,13 +98,13 @@ static void ticTexLine(tic_mem* memory, TexVertDep* v0, TexVertDep* v1)
 void tic_core_textri_dep(tic_core* core, float x1, float y1, float x2, float y2, float x3, float y3, float u1, float v1, float u2, float v2, float u3, float v3, bool use_map, u8* colors, s32 count)
 {
     tic_mem* memory = &core->memory;
-    tic_vram* vram = &memory->ram->vram;
+    tic_vram* vram = tic_core_vram((tic_core*)memory);
 
     u8* mapping = getPalette(memory, colors, count);
     TexVertDep V0, V1, V2;
 
     const u8* map = memory->ram->map.data;
-    tic_tilesheet sheet = getTileSheetFromSegment(memory, memory->ram->vram.blit.segment);
+    tic_tilesheet sheet = getTileSheetFromSegment(memory, tic_core_vram((tic_core*)memory)->blit.segment);
 
     V0.x = x1;  V0.y = y1;  V0.u = u1;  V0.v = v1;
     V1.x = x2;  V1.y = y2;  V1.u = u2;  V1.v = v2;
@@ -134,34 +126,34 @@ void tic_core_textri_dep(tic_core* core, float x1, float y1, float x2, float y2,
     s32 dudxs = (s32)(dudx * 65536.0f);
     s32 dvdxs = (s32)(dvdx * 65536.0f);
     //  fill the buffer 
-    for (s32 i = 0; i < COUNT_OF(SidesBuffer.Left); i++)
-        SidesBufferDep.Left[i] = TIC80_WIDTH, SidesBufferDep.Right[i] = -1;
+    for (s32 i = 0; i < COUNT_OF(core->raster.sides.left); i++)
+        core->raster.sides.left[i] = TIC80_WIDTH, core->raster.sides.right[i] = -1;
 
     //  parse each line and decide where in the buffer to store them ( left or right ) 
-    ticTexLine(memory, &V0, &V1);
-    ticTexLine(memory, &V1, &V2);
-    ticTexLine(memory, &V2, &V0);
+    ticTexLine(core, &V0, &V1);
+    ticTexLine(core, &V1, &V2);
+    ticTexLine(core, &V2, &V0);
 
     for (s32 y = 0; y < TIC80_HEIGHT; y++)
     {
         //  if it's backwards skip it
-        s32 width = SidesBufferDep.Right[y] - SidesBufferDep.Left[y];
+        s32 width = core->raster.sides.right[y] - core->raster.sides.left[y];
         //  if it's off top or bottom , skip this line
         if ((y < core->state.clip.t) || (y > core->state.clip.b))
             width = 0;
         if (width > 0)
         {
-            s32 u = SidesBufferDep.ULeft[y];
-            s32 v = SidesBufferDep.VLeft[y];
-            s32 left = SidesBufferDep.Left[y];
-            s32 right = SidesBufferDep.Right[y];
+            s32 u = core->raster.sides.uleft[y];
+            s32 v = core->raster.sides.vleft[y];
+            s32 left = core->raster.sides.left[y];
+            s32 right = core->raster.sides.right[y];
             //  check right edge, and CLAMP it
             if (right > core->state.clip.r)
                 right = core->state.clip.r;
             //  check left edge and offset UV's if we are off the left 
             if (left < core->state.clip.l)
             {
-                s32 dist = core->state.clip.l - SidesBufferDep.Left[y];
+                s32 dist = core->state.clip.l - core->raster.sides.left[y];
                 u += dudxs * dist;
                 v += dvdxs * dist;
                 left = core->state.clip.l;
@@ -206,4 +198,4 @@ void tic_core_textri_dep(tic_core* core, float x1, float y1, float x2, float y2,
             }
         }
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
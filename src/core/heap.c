@@ -0,0 +1,176 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "core.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// the small blocks the scripts churn through every frame come from pages carved into
+// equal slots per size class, the pages go back to the system only when the VM is closed,
+// the bigger blocks go straight to the system allocator
+
+enum
+{
+    Granule = 16,
+    MaxPooled = TIC_HEAP_CLASSES * Granule,
+    PageSize = 16 * 1024,
+    PageHeader = Granule, // keeps the slots aligned as malloc does
+};
+
+typedef struct Slot {struct Slot* next;} Slot;
+typedef struct Page {struct Page* next;} Page;
+
+static inline s32 sizeClass(size_t size)
+{
+    return size <= MaxPooled ? (s32)((size - 1) / Granule) : -1;
+}
+
+// bytes the block really takes, it's what counts toward the cap
+static inline size_t blockSize(size_t size)
+{
+    return size == 0 ? 0 : size <= MaxPooled ? (size + Granule - 1) / Granule * Granule : size;
+}
+
+static void* poolAlloc(tic_core* core, s32 index)
+{
+    Slot* slot = core->heap.free[index];
+
+    if(!slot)
+    {
+        u8* page = malloc(PageSize);
+
+        if(!page)
+            return NULL;
+
+        ((Page*)page)->next = core->heap.pages;
+        core->heap.pages = page;
+
+        const size_t size = (index + 1) * Granule;
+
+        for(u8* ptr = page + PageHeader; ptr + size <= page + PageSize; ptr += size)
+        {
+            ((Slot*)ptr)->next = slot;
+            slot = (Slot*)ptr;
+        }
+    }
+
+    core->heap.free[index] = slot->next;
+
+    return slot;
+}
+
+static void release(tic_core* core, void* ptr, size_t size)
+{
+    s32 index = sizeClass(size);
+
+    if(index < 0)
+        free(ptr);
+    else
+    {
+        ((Slot*)ptr)->next = core->heap.free[index];
+        core->heap.free[index] = ptr;
+    }
+}
+
+// a system block shrinking into a size class when there is no page for the class becomes a page of its own
+// with the one slot, so it goes back to the system with the pages instead of leaking from the free list
+static void* adopt(tic_core* core, void* ptr, size_t osize, size_t nsize)
+{
+    const size_t slot = blockSize(nsize);
+    u8* page = osize >= PageHeader + slot ? ptr : realloc(ptr, PageHeader + slot);
+
+    if(!page)
+        return NULL;
+
+    memmove(page + PageHeader, page, nsize);
+    ((Page*)page)->next = core->heap.pages;
+    core->heap.pages = page;
+
+    return page + PageHeader;
+}
+
+void* tic_core_heap_realloc(tic_core* core, void* ptr, size_t osize, size_t nsize)
+{
+    tic_stats* stats = &core->memory.stats;
+
+    if(!ptr)
+        osize = 0;
+
+    const size_t oblock = blockSize(osize);
+    const size_t nblock = blockSize(nsize);
+
+    if(nblock > oblock && stats->heap.cap && stats->heap.live - oblock + nblock > stats->heap.cap)
+        return NULL;
+
+    void* result = NULL;
+
+    if(nsize == 0)
+    {
+        if(ptr)
+            release(core, ptr, osize);
+    }
+    else if(ptr && sizeClass(osize) == sizeClass(nsize) && sizeClass(nsize) >= 0)
+        result = ptr;
+    else if(ptr && sizeClass(osize) < 0 && sizeClass(nsize) < 0)
+        result = realloc(ptr, nsize);
+    else
+    {
+        result = sizeClass(nsize) < 0 ? malloc(nsize) : poolAlloc(core, sizeClass(nsize));
+
+        if(result && ptr)
+        {
+            memcpy(result, ptr, MIN(osize, nsize));
+            release(core, ptr, osize);
+        }
+        else if(ptr && sizeClass(osize) < 0)
+            result = adopt(core, ptr, osize, nsize);
+    }
+
+    // a shrinking block stays where it is if there is no memory for the new one,
+    // unless it would be released to a pool it doesn't come from
+    if(nsize && !result)
+    {
+        if(nsize > osize || (sizeClass(osize) < 0 && sizeClass(nsize) >= 0))
+            return NULL;
+
+        result = ptr;
+    }
+
+    stats->heap.live = stats->heap.live - oblock + nblock;
+    stats->heap.peak = MAX(stats->heap.peak, stats->heap.live);
+
+    return result;
+}
+
+void tic_core_heap_reset(tic_core* core)
+{
+    for(Page* page = core->heap.pages; page;)
+    {
+        Page* next = page->next;
+        free(page);
+        page = next;
+    }
+
+    ZEROMEM(core->heap);
+    core->memory.stats.heap.live = 0;
+}
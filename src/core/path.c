@@ -0,0 +1,266 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "core.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// pathfinding over the map cells, moving up, down, left and right
+// through the tiles that don't have the given sprite flag set
+
+enum{Closed = 0xffff};
+
+static inline bool inMap(s32 x, s32 y)
+{
+    return x >= 0 && x < TIC_MAP_WIDTH && y >= 0 && y < TIC_MAP_HEIGHT;
+}
+
+static inline bool passable(const tic_mem* memory, s32 cell, u8 mask)
+{
+    return !(memory->ram->flags.data[memory->ram->map.data[cell]] & mask);
+}
+
+// collects the passable neighbours of the cell
+static inline s32 neighbours(const tic_mem* memory, s32 cell, u8 mask, s32* out)
+{
+    s32 x = cell % TIC_MAP_WIDTH, y = cell / TIC_MAP_WIDTH, count = 0;
+
+    if(x > 0 && passable(memory, cell - 1, mask))                              out[count++] = cell - 1;
+    if(x < TIC_MAP_WIDTH - 1 && passable(memory, cell + 1, mask))              out[count++] = cell + 1;
+    if(y > 0 && passable(memory, cell - TIC_MAP_WIDTH, mask))                  out[count++] = cell - TIC_MAP_WIDTH;
+    if(y < TIC_MAP_HEIGHT - 1 && passable(memory, cell + TIC_MAP_WIDTH, mask)) out[count++] = cell + TIC_MAP_WIDTH;
+
+    return count;
+}
+
+typedef struct
+{
+    tic_core* core;
+    s32 size;
+    s32 gx, gy;
+} Open;
+
+// estimated length of the path through the cell, the manhattan distance is exact on an open map
+static inline s32 estimate(const Open* open, s32 cell)
+{
+    return open->core->path.cost[cell]
+        + abs(cell % TIC_MAP_WIDTH - open->gx)
+        + abs(cell / TIC_MAP_WIDTH - open->gy);
+}
+
+// ties go to the cell that is further from the start, it's closer to the goal then
+static inline bool before(const Open* open, s32 a, s32 b)
+{
+    s32 fa = estimate(open, a), fb = estimate(open, b);
+    return fa < fb || (fa == fb && open->core->path.cost[a] > open->core->path.cost[b]);
+}
+
+static inline void place(Open* open, s32 i, s32 cell)
+{
+    open->core->path.queue[i] = cell;
+    open->core->path.index[cell] = i;
+}
+
+static void siftUp(Open* open, s32 i)
+{
+    u16* heap = open->core->path.queue;
+    s32 cell = heap[i];
+
+    for(; i > 0 && before(open, cell, heap[(i - 1) / 2]); i = (i - 1) / 2)
+        place(open, i, heap[(i - 1) / 2]);
+
+    place(open, i, cell);
+}
+
+static s32 pop(Open* open)
+{
+    u16* heap = open->core->path.queue;
+    s32 top = heap[0];
+    s32 cell = heap[--open->size];
+
+    s32 i = 0;
+    for(s32 child; (child = i * 2 + 1) < open->size; i = child)
+    {
+        if(child + 1 < open->size && before(open, heap[child + 1], heap[child]))
+            child++;
+
+        if(!before(open, heap[child], cell))
+            break;
+
+        place(open, i, heap[child]);
+    }
+
+    if(open->size)
+        place(open, i, cell);
+
+    open->core->path.index[top] = Closed;
+    return top;
+}
+
+// writes the path to the goal, without the start, over the open cells
+static s32 backtrack(tic_core* core, s32 start, s32 goal)
+{
+    s32 count = 0;
+
+    for(s32 cell = goal; cell != start; cell = core->path.from[cell])
+        count++;
+
+    for(s32 cell = goal, i = count; cell != start; cell = core->path.from[cell])
+        core->path.queue[--i] = cell;
+
+    return count;
+}
+
+s32 tic_api_path(tic_mem* memory, s32 x0, s32 y0, s32 x1, s32 y1, s32 flag, const u16** cells)
+{
+    tic_core* core = (tic_core*)memory;
+
+    *cells = core->path.queue;
+
+    if(!inMap(x0, y0) || !inMap(x1, y1) || flag < 0 || flag >= BITS_IN_BYTE)
+        return 0;
+
+    const u8 mask = 1 << flag;
+
+    s32 start = x0 + y0 * TIC_MAP_WIDTH;
+    s32 goal = x1 + y1 * TIC_MAP_WIDTH;
+
+    if(start == goal || !passable(memory, goal, mask))
+        return 0;
+
+    // marks from the previous searches are dropped when the generation wraps
+    if(++core->path.generation == 0)
+    {
+        ZEROMEM(core->path.mark);
+        core->path.generation = 1;
+    }
+
+    const u16 generation = core->path.generation;
+    Open open = {core, 0, x1, y1};
+
+    core->path.mark[start] = generation;
+    core->path.cost[start] = 0;
+    place(&open, open.size++, start);
+
+    while(open.size)
+    {
+        s32 cell = pop(&open);
+
+        if(cell == goal)
+            return backtrack(core, start, goal);
+
+        s32 next[4];
+        s32 cost = core->path.cost[cell] + 1;
+
+        for(s32 i = 0, count = neighbours(memory, cell, mask, next); i < count; i++)
+        {
+            s32 n = next[i];
+
+            if(core->path.mark[n] != generation)
+            {
+                core->path.mark[n] = generation;
+                core->path.cost[n] = cost;
+                core->path.from[n] = cell;
+                place(&open, open.size, n);
+                siftUp(&open, open.size++);
+            }
+            else if(core->path.index[n] != Closed && cost < core->path.cost[n])
+            {
+                core->path.cost[n] = cost;
+                core->path.from[n] = cell;
+                siftUp(&open, core->path.index[n]);
+            }
+        }
+    }
+
+    return 0;
+}
+
+s32 tic_api_flow(tic_mem* memory, s32 x, s32 y, s32 flag)
+{
+    tic_core* core = (tic_core*)memory;
+
+    core->path.target = -1;
+
+    if(!inMap(x, y) || flag < 0 || flag >= BITS_IN_BYTE)
+        return 0;
+
+    const u8 mask = 1 << flag;
+
+    s32 target = x + y * TIC_MAP_WIDTH;
+
+    if(!passable(memory, target, mask))
+        return 0;
+
+    // every step costs the same, so breadth first order gives the exact distances
+    u16* flow = core->path.flow;
+    u16* queue = core->path.queue;
+
+    memset(flow, 0xff, sizeof core->path.flow);
+
+    s32 head = 0, tail = 0;
+    flow[target] = 0;
+    queue[tail++] = target;
+
+    while(head != tail)
+    {
+        s32 cell = queue[head++];
+        s32 next[4];
+
+        for(s32 i = 0, count = neighbours(memory, cell, mask, next); i < count; i++)
+            if(flow[next[i]] == TIC_PATH_UNREACHABLE)
+            {
+                flow[next[i]] = flow[cell] + 1;
+                queue[tail++] = next[i];
+            }
+    }
+
+    core->path.target = target;
+
+    return tail;
+}
+
+s32 tic_api_flowstep(tic_mem* memory, s32 x, s32 y)
+{
+    tic_core* core = (tic_core*)memory;
+
+    if(core->path.target < 0 || !inMap(x, y))
+        return -1;
+
+    const u16* flow = core->path.flow;
+    s32 cell = x + y * TIC_MAP_WIDTH;
+
+    if(flow[cell] == TIC_PATH_UNREACHABLE)
+        return -1;
+
+    const s32 steps[] = {-1, 1, -TIC_MAP_WIDTH, TIC_MAP_WIDTH};
+    const bool open[] = {x > 0, x < TIC_MAP_WIDTH - 1, y > 0, y < TIC_MAP_HEIGHT - 1};
+
+    s32 best = cell;
+
+    for(s32 i = 0; i < COUNT_OF(steps); i++)
+        if(open[i] && flow[cell + steps[i]] < flow[best])
+            best = cell + steps[i];
+
+    return best;
+}
@@ -523,6 +523,17 @@ static void stereo_synthesize(tic_core* core, tic_sound_register_data* registers
     blip_end_frame(blip, EndTime);
 }
 
+static inline void advanceSoundTail(tic_core* core)
+{
+    // if the head has advanced, we can advance the tail too. Otherwise, we just
+    // keep synthesizing audio using the last known register values, so at least we don't get crackles
+    if (core->state.sound_ringbuf_tail != core->state.sound_ringbuf_head) {
+        // note: we assume storing a 32 bit integer is atomic, that should hold on pretty much any modern processor
+        // assuming it is aligned in memory (which it should be)
+        core->state.sound_ringbuf_tail = (core->state.sound_ringbuf_tail + 1) % TIC_SOUND_RINGBUF_LEN;
+    }
+}
+
 void tic_core_synth_sound(tic_mem* memory)
 {
     tic_core* core = (tic_core*)memory;
@@ -534,13 +545,14 @@ void tic_core_synth_sound(tic_mem* memory)
     blip_read_samples(core->blip.left, core->memory.product.samples.buffer, core->samplerate / TIC80_FRAMERATE, TIC80_SAMPLE_CHANNELS);
     blip_read_samples(core->blip.right, core->memory.product.samples.buffer + 1, core->samplerate / TIC80_FRAMERATE, TIC80_SAMPLE_CHANNELS);
 
-    // if the head has advanced, we can advance the tail too. Otherwise, we just
-    // keep synthesizing audio using the last known register values, so at least we don't get crackles
-    if (core->state.sound_ringbuf_tail != core->state.sound_ringbuf_head) {
-        // note: we assume storing a 32 bit integer is atomic, that should hold on pretty much any modern processor
-        // assuming it is aligned in memory (which it should be)
-        core->state.sound_ringbuf_tail = (core->state.sound_ringbuf_tail + 1) % TIC_SOUND_RINGBUF_LEN;
-    }
+    advanceSoundTail(core);
+}
+
+void tic_core_skip_sound(tic_mem* memory)
+{
+    // consume the registers of the frame without running the synth,
+    // so the ring buffer stays in step with the ticks
+    advanceSoundTail((tic_core*)memory);
 }
 
 void tic_core_sound_tick_start(tic_mem* memory)
@@ -431,7 +431,7 @@ static void drawSheetVBank1(Map* map, s32 x, s32 y)
 static void initBlitMode(Map* map)
 {
     tic_mem* tic = map->tic;
-    tiles2ram(tic->ram, getBankTiles(map->studio));
+    tiles2ram(tic, getBankTiles(map->studio));
     tic->ram->vram.blit.segment = tic_blit_calc_segment(&map->sheet.blit);
 }
 
@@ -486,7 +486,7 @@ static void drawSheetReg(Map* map, s32 x, s32 y)
 
     tic_api_clip(tic, x, y + map->anim.pos.sheet, TIC_SPRITESHEET_SIZE, TIC_SPRITESHEET_SIZE);
 
-    tiles2ram(tic->ram, getBankTiles(map->studio));
+    tiles2ram(tic, getBankTiles(map->studio));
 
     tic_blit blit = map->sheet.blit;
     SCOPE(resetBlitMode(map->tic), tic_api_clip(tic, 0, 0, TIC80_WIDTH, TIC80_HEIGHT))
@@ -1866,7 +1866,7 @@ static void drawTumbler(Music* music, s32 x, s32 y, s32 index)
     drawEditPanel(music, x, y, Width, Height);
 
     u8 color = tic_color_black;
-    tiles2ram(tic->ram, &getConfig(music->studio)->cart->bank0.tiles);
+    tiles2ram(tic, &getConfig(music->studio)->cart->bank0.tiles);
     tic_api_spr(tic, music->on[index] ? On : Off, x, y, 1, 1, &color, 1, 1, tic_no_flip, tic_no_rotate);
 }
 
@@ -2225,7 +2225,7 @@ static void drawPianoRoll(Music* music, s32 x, s32 y)
         {10, 41, 42, 36, tic_no_flip},
     };
 
-    tiles2ram(tic->ram, &getConfig(music->studio)->cart->bank0.tiles);
+    tiles2ram(tic, &getConfig(music->studio)->cart->bank0.tiles);
 
     for(s32 i = 0; i < COUNT_OF(Buttons); i++)
     {
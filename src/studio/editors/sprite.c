@@ -1359,7 +1359,7 @@ static void drawSheetVBank1(Sprite* sprite, s32 x, s32 y)
 static void drawSheet(Sprite* sprite, s32 x, s32 y)
 {
     tic_mem* tic = sprite->tic;
-    tiles2ram(tic->ram, sprite->src);
+    tiles2ram(tic, sprite->src);
 
     tic_blit blit = sprite->blit;
     SCOPE(tic->ram->vram.blit.segment = TIC_DEFAULT_BLIT_MODE)
@@ -128,6 +128,7 @@
     macro(bank)                 \
     macro(vbank)                \
     macro(id)                   \
+    macro(bytecode)             \
     ALONE_KEY(macro)
 
 static const char* WelcomeText =
@@ -1493,6 +1494,24 @@ static void onFolderCommand(Console* console)
     commandDone(console);
 }
 
+static void onMemoryCommand(Console* console)
+{
+    const tic_stats* stats = &console->tic->stats;
+    char buf[TICNAME_MAX];
+
+    snprintf(buf, sizeof buf, "\nscript heap: %llu KB live, %llu KB peak",
+        (unsigned long long)stats->heap.live / 1024, (unsigned long long)stats->heap.peak / 1024);
+    printBack(console, buf);
+
+    if(stats->heap.cap)
+    {
+        snprintf(buf, sizeof buf, ", %llu MB cap", (unsigned long long)(stats->heap.cap >> 20));
+        printBack(console, buf);
+    }
+
+    commandDone(console);
+}
+
 static void onClsCommand(Console* console)
 {
     memset(console->text, 0, CONSOLE_BUFFER_SIZE);
@@ -2070,9 +2089,21 @@ static void onNativeExportGet(const net_get_data* data)
     }
 }
 
+// the cart keeps the code compiled by the last run only when it's asked for
+static void storeBytecode(Console* console, bool store)
+{
+    if(store)
+    {
+        if(!tic_core_bytecode_store(console->tic))
+            printError(console, "\nbytecode isn't stored, run the cart first");
+    }
+    else console->tic->cart.bytecode.size = 0;
+}
+
 static void exportGame(Console* console, const char* name, const char* system, net_get_callback callback, ExportParams params)
 {
     tic_mem* tic = console->tic;
+    storeBytecode(console, params.bytecode);
     printLine(console);
     GameExportData data = {console};
     strcpy(data.filename, name);
@@ -2511,6 +2542,8 @@ static CartSaveResult saveCart(Console* console)
 
 static void onSaveCommandConfirmed(Console* console)
 {
+    storeBytecode(console, console->desc->count > 1 && strcmp(console->desc->params[1].key, "bytecode") == 0);
+
     CartSaveResult rom = saveCartName(console, console->desc->count ? console->desc->params->key : NULL);
 
     if(rom == CART_SAVE_OK)
@@ -2802,8 +2835,10 @@ static const char HelpUsage[] = "help [<text>"
     macro("save",                                                                       \
         NULL,                                                                           \
         "save cartridge to the local filesystem, use $LANG_EXTENSIONS$"                 \
-        "cart extension to save it in text format (PRO feature).",                      \
-        "save <cart>",                                                                  \
+        "cart extension to save it in text format (PRO feature),\n"                     \
+        "add bytecode to store the code compiled by the last run (Lua and JS),\n"       \
+        "it's loaded only by this TIC-80 or the player the cart is exported to.",       \
+        "save <cart> [bytecode]",                                                       \
         onSaveCommand,                                                                  \
         tabCompleteFiles,                                                               \
         NULL)                                                                           \
@@ -2893,6 +2928,15 @@ static const char HelpUsage[] = "help [<text>"
         tabCompleteFilesAndDirs,                                                        \
         NULL)                                                                           \
                                                                                         \
+    macro("memory",                                                                     \
+        "mem",                                                                          \
+        "show the memory the cart's script holds now and at most since it started,\n"   \
+        "add `memory: <MB>` metatag to the code to cap it.",                            \
+        NULL,                                                                           \
+        onMemoryCommand,                                                                \
+        NULL,                                                                           \
+        NULL)                                                                           \
+                                                                                        \
     macro("cls",                                                                        \
         "clear",                                                                        \
         "clear console screen.",                                                        \
@@ -40,6 +40,7 @@ static void reset(Start* start)
     u8 val = Reset[sizeof(Reset) * (start->ticks % TIC80_FRAMERATE) / TIC80_FRAMERATE];
 
     for(s32 i = 0; i < sizeof(tic_tile); i++) tile[i] = val;
+    tic_core_tiles_invalidate(start->tic, 0, 1);
 
     tic_api_map(start->tic, 0, 0, TIC_MAP_SCREEN_WIDTH, TIC_MAP_SCREEN_HEIGHT + (TIC80_HEIGHT % TIC_SPRITESIZE ? 1 : 0), 0, 0, 0, 0, 1, NULL, NULL);
 }
@@ -215,6 +216,8 @@ void initStart(Start* start, Studio* studio, const char* cart)
                             if(dataSize)
                             {
                                 tic_cart_load(&start->tic->cart, data, dataSize);
+                                // the cart is a part of the app, its bytecode is as safe as the app itself
+                                tic_core_bytecode_trust(start->tic, &start->tic->cart.bytecode);
                                 tic_api_reset(start->tic);
                                 start->embed = true;
                             }
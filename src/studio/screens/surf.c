@@ -96,7 +96,7 @@ static void drawTopToolbar(Surf* surf, s32 x, s32 y)
     enum{Gap = 10, TipX = 150, SelectWidth = 54};
 
     u8 colorkey = 0;
-    tiles2ram(tic->ram, &getConfig(surf->studio)->cart->bank0.tiles);
+    tiles2ram(tic, &getConfig(surf->studio)->cart->bank0.tiles);
     tic_api_spr(tic, 12, TipX, y+1, 1, 1, &colorkey, 1, 1, tic_no_flip, tic_no_rotate);
     {
         static const char Label[] = "SELECT";
@@ -145,7 +145,7 @@ static void drawBottomToolbar(Surf* surf, s32 x, s32 y)
 
         u8 colorkey = 0;
 
-        tiles2ram(tic->ram, &getConfig(surf->studio)->cart->bank0.tiles);
+        tiles2ram(tic, &getConfig(surf->studio)->cart->bank0.tiles);
         tic_api_spr(tic, 15, TipX + SelectWidth, y + 1, 1, 1, &colorkey, 1, 1, tic_no_flip, tic_no_rotate);
         {
             static const char Label[] = "WEBSITE";
@@ -732,7 +732,10 @@ static void tick(Surf* surf)
         tic_screen* cover = getMenuItem(surf)->cover;
 
         if(cover)
+        {
             memcpy(tic->ram->vram.screen.data, cover->data, sizeof(tic_screen));
+            tic_core_blit_invalidate(tic, 0, TIC80_FULLHEIGHT);
+        }
     }
 
     VBANK(tic, 1)
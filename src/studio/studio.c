@@ -20,6 +20,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#if defined(_WIN32)
+// declares rand_s, see randomBytes
+#define _CRT_RAND_S
+#endif
+
 #include "studio.h"
 
 #if defined(BUILD_EDITORS)
@@ -239,9 +244,18 @@ void map2ram(tic_ram* ram, const tic_map* src)
     memcpy(ram->map.data, src, sizeof ram->map);
 }
 
-void tiles2ram(tic_ram* ram, const tic_tiles* src)
+void tiles2ram(tic_mem* tic, const tic_tiles* src)
 {
-    memcpy(ram->tiles.data, src, sizeof ram->tiles * TIC_SPRITE_BANKS);
+    // copy only the tiles that changed to keep the unpacked cache of the rest
+    const tic_tile* from = (const tic_tile*)src;
+    tic_tile* to = (tic_tile*)&tic->ram->tiles;
+
+    for(s32 i = 0; i < TIC_SPRITES; i++)
+        if(memcmp(&to[i], &from[i], sizeof(tic_tile)))
+        {
+            to[i] = from[i];
+            tic_core_tiles_invalidate(tic, i, 1);
+        }
 }
 
 static inline void sfx2ram(tic_ram* ram, const tic_sfx* src)
@@ -513,6 +527,56 @@ static void md5(const void* voidData, s32 length, u8 digest[MD5_HASHSIZE])
     MD5_Final(digest, &c);
 }
 
+static bool randomBytes(u8* data, s32 size)
+{
+#if defined(__TIC_WINDOWS__)
+    for(s32 i = 0; i < size; i++)
+    {
+        u32 value;
+        if(rand_s(&value) != 0)
+            return false;
+
+        data[i] = (u8)value;
+    }
+
+    return true;
+#else
+    FILE* file = fopen("/dev/urandom", "rb");
+    bool done = false;
+
+    if(file)
+    {
+        done = fread(data, 1, size, file) == size;
+        fclose(file);
+    }
+
+    return done;
+#endif
+}
+
+// the carts saved with bytecode are signed with a random key made on the first start of this build,
+// so the bytecode of a cart that comes from anywhere else is never loaded, see tic_core_bytecode_key
+static void initBytecodeKey(Studio* studio)
+{
+    static const char BytecodeKeyPath[] = TIC_LOCAL_VERSION "bytecode.key";
+
+    u8 key[TIC_BYTECODE_KEY];
+    s32 size = 0;
+    u8* data = tic_fs_loadroot(studio->fs, BytecodeKeyPath, &size);
+    bool done = data && size == sizeof key;
+
+    if(done)
+        memcpy(key, data, sizeof key);
+
+    free(data);
+
+    if(!done && randomBytes(key, sizeof key))
+        done = tic_fs_saveroot(studio->fs, BytecodeKeyPath, key, sizeof key, true);
+
+    if(done)
+        tic_core_bytecode_key(studio->tic, key);
+}
+
 const char* md5str(const void* data, s32 length)
 {
     static char res[MD5_HASHSIZE * 2 + 1];
@@ -985,6 +1049,8 @@ static void drawPopup(Studio* studio)
             for(s32 i = 0, y = 0; y < (Height + studio->anim.pos.popup); y++, dst += TIC80_MARGIN_RIGHT + TIC80_MARGIN_LEFT)
                 for(s32 x = 0; x < Width; x++)
                 *dst++ = tic_rgba(&bank->palette.vbank0.colors[tic_tool_peek4(tic->ram->vram.screen.data, i++)]);
+
+            tic_core_blit_invalidate(tic, TIC80_MARGIN_TOP, Height + studio->anim.pos.popup);
         }        
     }
 }
@@ -2182,6 +2248,8 @@ static void blitCursor(Studio* studio)
                     if(c)
                         *dst = tic_rgba(&pal->colors[c]);
                 }
+
+        tic_core_blit_invalidate(tic, s.y, TIC_SPRITESIZE);
     }
 }
 
@@ -2534,6 +2602,7 @@ Studio* studio_create(s32 argc, char **argv, s32 samplerate, tic80_pixel_color_f
     tic_fs_makedir(studio->fs, TIC_LOCAL_VERSION);
     
     initConfig(studio->config, studio, studio->fs);
+    initBytecodeKey(studio);
 
     if (studio->config->data.uiScale > maxscale)
     {
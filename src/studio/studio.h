@@ -275,5 +275,5 @@ const char* md5str(const void* data, s32 length);
 void sfx_stop(tic_mem* tic, s32 channel);
 s32 calcWaveAnimation(tic_mem* tic, u32 index, s32 channel);
 void map2ram(tic_ram* ram, const tic_map* src);
-void tiles2ram(tic_ram* ram, const tic_tiles* src);
+void tiles2ram(tic_mem* tic, const tic_tiles* src);
 void fadePalette(tic_palette* pal, s32 value);
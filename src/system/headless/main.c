@@ -0,0 +1,482 @@
+// MIT License
+
+// Copyright (c) 2020 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tic80.h>
+#include <tic80_batch.h>
+#include "tools.h"
+#include "argparse.h"
+#include "ext/png.h"
+#include "ext/md5.h"
+
+#define TIC80_EXECUTABLE_NAME "tic80-headless"
+#define TIC80_DEFAULT_FRAMES 600
+#define PNG_EXT ".png"
+#define MD5_HASHSIZE 16
+
+#define HEADLESS_PARAMS_LIST(macro)                                                                 \
+    macro(frames,   s32,    INTEGER,    "number of frames to run [" DEF2STR(TIC80_DEFAULT_FRAMES) "]")  \
+    macro(blit,     s32,    INTEGER,    "blit the screen every Nth frame, 0 to never blit [1]")     \
+    macro(mute,     bool,   BOOLEAN,    "skip sound synthesis")                                     \
+    macro(bench,    bool,   BOOLEAN,    "compare steps/sec with and without blit and sound")        \
+    macro(hash,     char*,  STRING,     "write per-frame framebuffer md5 hashes to the file")       \
+    macro(perspective, s32, INTEGER,    "ttri perspective correction every Nth pixel [1]")          \
+    macro(gc,       s32,    INTEGER,    "collect script garbage after each frame for N microseconds [0]") \
+    macro(instances, s32,   INTEGER,    "run N instances on all CPUs and check they draw the frames of a single one") \
+    macro(trace,    bool,   BOOLEAN,    "print cart trace() output")
+
+typedef struct
+{
+    const char* cart;
+#define HEADLESS_PARAMS_DEF(name, ctype, type, help) ctype name;
+    HEADLESS_PARAMS_LIST(HEADLESS_PARAMS_DEF)
+#undef  HEADLESS_PARAMS_DEF
+} Args;
+
+static struct
+{
+    u64 frame;
+    bool trace;
+    s32 perspective;
+    s32 gc;
+    bool quit;
+    bool error;
+    tic_stats stats;
+} state;
+
+static void onTrace(const char* text, u8 color)
+{
+    if(state.trace)
+        printf("%s\n", text);
+}
+
+static void onError(const char* info)
+{
+    fprintf(stderr, "error at frame %llu: %s\n", (unsigned long long)state.frame, info);
+    state.error = true;
+}
+
+static void onExit()
+{
+    state.quit = true;
+}
+
+// the cart sees a virtual 60Hz clock, so time() based carts stay deterministic
+// no matter how fast the frames are actually stepped
+static u64 counter()
+{
+    return state.frame;
+}
+
+static u64 freq()
+{
+    return TIC80_FRAMERATE;
+}
+
+static double seconds()
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* loadFile(const char* path, s32* size)
+{
+    FILE* file = fopen(path, "rb");
+    void* data = NULL;
+
+    if(file)
+    {
+        fseek(file, 0, SEEK_END);
+        *size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        data = malloc(*size);
+
+        if(data && fread(data, *size, 1, file) != 1)
+        {
+            free(data);
+            data = NULL;
+        }
+
+        fclose(file);
+    }
+
+    return data;
+}
+
+static void* loadCart(const char* path, s32* size)
+{
+    void* data = loadFile(path, size);
+
+    if(data && tic_tool_has_ext(path, PNG_EXT))
+    {
+        png_buffer zip = png_decode((png_buffer){data, *size});
+        free(data);
+        data = NULL;
+
+        if(zip.size)
+        {
+            png_buffer buf = png_create(sizeof(tic_cartridge));
+
+            buf.size = tic_tool_unzip(buf.data, buf.size, zip.data, zip.size);
+            free(zip.data);
+
+            if(buf.size)
+            {
+                data = buf.data;
+                *size = buf.size;
+            }
+            else free(buf.data);
+        }
+    }
+
+    return data;
+}
+
+static void md5(const void* data, s32 size, u8 digest[MD5_HASHSIZE])
+{
+    MD5_CTX c;
+
+    MD5_Init(&c);
+    MD5_Update(&c, data, size);
+    MD5_Final(digest, &c);
+}
+
+static void writeHash(FILE* file, const u32* screen)
+{
+    u8 digest[MD5_HASHSIZE];
+    md5(screen, TIC80_FULLWIDTH * TIC80_FULLHEIGHT * sizeof screen[0], digest);
+
+    fprintf(file, "%llu ", (unsigned long long)state.frame);
+
+    for(s32 i = 0; i < MD5_HASHSIZE; i++)
+        fprintf(file, "%02x", digest[i]);
+
+    fprintf(file, "\n");
+}
+
+static Args parseArgs(s32 argc, char **argv)
+{
+    static const char *const usage[] = 
+    {
+        TIC80_EXECUTABLE_NAME " <cart> [options]",
+        NULL,
+    };
+
+    Args args = {.frames = TIC80_DEFAULT_FRAMES, .blit = 1, .perspective = 1};
+
+    struct argparse_option options[] = 
+    {
+        OPT_HELP(),
+#define HEADLESS_PARAMS_DEF(name, ctype, type, help) OPT_##type('\0', #name, &args.name, help),
+        HEADLESS_PARAMS_LIST(HEADLESS_PARAMS_DEF)
+#undef  HEADLESS_PARAMS_DEF
+        OPT_END(),
+    };
+
+    struct argparse argparse;
+    argparse_init(&argparse, options, usage, 0);
+    argparse_describe(&argparse, "\nRuns a cart without display or audio as fast as possible.", NULL);
+    argc = argparse_parse(&argparse, argc, (const char**)argv);
+
+    if(argc == 1)
+        args.cart = argv[0];
+
+    return args;
+}
+
+static double run(void* cart, s32 size, s32 frames, s32 blit, bool mute, FILE* hashFile)
+{
+    tic80* tic = tic80_create(TIC80_SAMPLERATE, TIC80_PIXEL_COLOR_RGBA8888);
+    tic->callback.trace = onTrace;
+    tic->callback.error = onError;
+    tic->callback.exit = onExit;
+    tic80_perspective(tic, state.perspective);
+    tic80_gc(tic, state.gc);
+    tic80_load(tic, cart, size);
+
+    tic80_input input;
+    memset(&input, 0, sizeof input);
+
+    state.quit = state.error = false;
+
+    double start = seconds();
+
+    for(state.frame = 0; state.frame < frames && !state.quit && !state.error; state.frame++)
+    {
+        bool blitted = blit > 0 && state.frame % blit == 0;
+
+        tic80_step(tic, input, counter, freq, 
+            (blitted ? 0 : TIC80_STEP_SKIP_BLIT) | (mute ? TIC80_STEP_SKIP_SOUND : 0));
+
+        if(hashFile && blitted)
+            writeHash(hashFile, tic->screen);
+    }
+
+    double elapsed = seconds() - start;
+
+    state.stats = ((tic_mem*)tic)->stats;
+    tic80_delete(tic);
+
+    return elapsed;
+}
+
+// called from the batch threads, so it only prints, the batch keeps the status
+static void onInstanceError(const char* info)
+{
+    fprintf(stderr, "error: %s\n", info);
+}
+
+static tic80_batch* createBatch(void* cart, s32 size, s32 count, s32 threads)
+{
+    tic80_batch* batch = tic80_batch_create(count, threads, TIC80_PIXEL_COLOR_RGBA8888);
+
+    for(s32 i = 0; i < count; i++)
+    {
+        tic80* tic = tic80_batch_get(batch, i);
+        tic->callback.error = onInstanceError;
+        tic80_perspective(tic, state.perspective);
+        tic80_gc(tic, state.gc);
+    }
+
+    tic80_batch_load(batch, cart, size);
+
+    return batch;
+}
+
+// steps a single instance on this thread and keeps the digest of every frame and the status after it,
+// these are the golden frames the parallel instances are checked against, returns the frames it ran
+static s32 golden(void* cart, s32 size, s32 frames, bool mute, u8 (*digests)[MD5_HASHSIZE], u32* status)
+{
+    tic80_batch* batch = createBatch(cart, size, 1, 1);
+    tic80_batch_get(batch, 0)->callback.trace = onTrace;
+
+    s32 obs = tic80_batch_observe(batch, TIC80_BATCH_OBS_SCREEN, 0, 0);
+    u8* screen = malloc(obs);
+    tic80_input input = {0};
+    s32 frame = 0;
+
+    while(frame < frames)
+    {
+        tic80_batch_step(batch, &input, screen, mute ? TIC80_STEP_SKIP_SOUND : 0);
+        md5(screen, obs, digests[frame]);
+        status[frame] = tic80_batch_status(batch, 0);
+
+        if(status[frame++] != TIC80_BATCH_RUNNING)
+            break;
+    }
+
+    free(screen);
+    tic80_batch_delete(batch);
+
+    return frame;
+}
+
+// steps the instances in parallel and compares their screens with the golden frames every frame,
+// returns the number of instances that drew a different frame or stopped differently
+static s32 stress(void* cart, s32 size, s32 frames, s32 count, bool mute, double* elapsed)
+{
+    u8 (*digests)[MD5_HASHSIZE] = malloc((size_t)MAX(frames, 1) * MD5_HASHSIZE);
+    u32* expected = malloc((size_t)MAX(frames, 1) * sizeof *expected);
+
+    frames = golden(cart, size, frames, mute, digests, expected);
+
+    tic80_batch* batch = createBatch(cart, size, count, 0);
+
+    s32 obs = tic80_batch_observe(batch, TIC80_BATCH_OBS_SCREEN, 0, 0);
+    u8* screens = malloc((size_t)obs * count);
+    tic80_input* inputs = calloc(count, sizeof(tic80_input));
+    bool* failed = calloc(count, sizeof(bool));
+    s32 failures = 0;
+
+    double start = seconds();
+
+    for(state.frame = 0; state.frame < frames; state.frame++)
+    {
+        tic80_batch_step(batch, inputs, screens, mute ? TIC80_STEP_SKIP_SOUND : 0);
+
+        for(s32 i = 0; i < count; i++)
+        {
+            u8 digest[MD5_HASHSIZE];
+            u32 status = tic80_batch_status(batch, i);
+
+            if(failed[i])
+                continue;
+
+            md5(screens + (size_t)obs * i, obs, digest);
+
+            if(status != expected[state.frame])
+                fprintf(stderr, "instance %d has status %u instead of %u at frame %llu\n", 
+                    i, status, expected[state.frame], (unsigned long long)state.frame);
+            else if(memcmp(digest, digests[state.frame], MD5_HASHSIZE) != 0)
+                fprintf(stderr, "instance %d differs from the single-threaded run at frame %llu\n", 
+                    i, (unsigned long long)state.frame);
+            else continue;
+
+            failed[i] = true;
+            failures++;
+        }
+    }
+
+    *elapsed = seconds() - start;
+
+    free(failed);
+    free(inputs);
+    free(screens);
+    free(expected);
+    free(digests);
+    tic80_batch_delete(batch);
+
+    return failures;
+}
+
+static void report(const char* name, double elapsed, double base)
+{
+    double fps = elapsed > 0 ? state.frame / elapsed : 0;
+
+    printf("%-12s %8llu frames in %8.3f s, %10.1f steps/sec", name, 
+        (unsigned long long)state.frame, elapsed, fps);
+
+    if(base > 0 && elapsed > 0)
+        printf(", x%.2f", base / elapsed);
+
+    printf("\n");
+}
+
+static void bench(void* cart, s32 size, s32 frames)
+{
+    static const struct
+    {
+        const char* name;
+        s32 blit;
+        bool mute;
+    } Modes[] = 
+    {
+        {"full",        1, false},
+        {"no blit",     0, false},
+        {"no sound",    1, true},
+        {"no blit/snd", 0, true},
+    };
+
+    double base = 0;
+
+    for(s32 i = 0; i < COUNT_OF(Modes) && !state.error; i++)
+    {
+        double elapsed = run(cart, size, frames, Modes[i].blit, Modes[i].mute, NULL);
+
+        if(i == 0)
+            base = elapsed;
+
+        report(Modes[i].name, elapsed, i ? base : 0);
+    }
+}
+
+s32 main(s32 argc, char **argv)
+{
+    Args args = parseArgs(argc, argv);
+
+    if(!args.cart)
+    {
+        fprintf(stderr, "usage: " TIC80_EXECUTABLE_NAME " <cart> [options]\n");
+        return 1;
+    }
+
+    s32 size = 0;
+    void* cart = loadCart(args.cart, &size);
+
+    if(!cart)
+    {
+        fprintf(stderr, "error: could not load %s\n", args.cart);
+        return 1;
+    }
+
+    state.trace = args.trace;
+    state.perspective = args.perspective;
+    state.gc = args.gc;
+
+    if(args.instances > 0)
+    {
+        double elapsed = 0;
+        s32 failures = stress(cart, size, args.frames, args.instances, args.mute, &elapsed);
+
+        printf("%s: %d instances x %llu frames in %.3f s, %.1f steps/sec, %d failed\n", args.cart, 
+            args.instances, (unsigned long long)state.frame, elapsed, 
+            elapsed > 0 ? state.frame * args.instances / elapsed : 0, failures);
+
+        state.error = failures > 0;
+    }
+    else if(args.bench)
+    {
+        printf("%s:\n", args.cart);
+        bench(cart, size, args.frames);
+    }
+    else
+    {
+        FILE* hashFile = NULL;
+
+        if(args.hash && !(hashFile = fopen(args.hash, "w")))
+        {
+            fprintf(stderr, "error: could not open %s\n", args.hash);
+            free(cart);
+            return 1;
+        }
+
+        double elapsed = run(cart, size, args.frames, args.blit, args.mute, hashFile);
+        report(args.cart, elapsed, 0);
+
+        if(state.stats.blit.rows)
+        {
+            printf("blit: %llu of %llu rows skipped\n", 
+                (unsigned long long)state.stats.blit.skipped, (unsigned long long)state.stats.blit.rows);
+            printf("palettes: %llu expanded, %.2f per frame\n", (unsigned long long)state.stats.blit.palettes,
+                (double)state.stats.blit.palettes * TIC80_FULLHEIGHT / state.stats.blit.rows);
+        }
+
+        if(state.stats.tiles.hits + state.stats.tiles.misses)
+            printf("tiles: %llu hits, %llu misses\n", 
+                (unsigned long long)state.stats.tiles.hits, (unsigned long long)state.stats.tiles.misses);
+
+        if(state.stats.map.hits + state.stats.map.misses)
+            printf("map: %llu cells cached, %llu unpacked\n", 
+                (unsigned long long)state.stats.map.hits, (unsigned long long)state.stats.map.misses);
+
+        if(state.gc)
+            printf("gc: %llu cycles in %.3f ms, %llu us last frame, %llu KB heap\n", 
+                (unsigned long long)state.stats.gc.cycles, state.stats.gc.time / 1000.0,
+                (unsigned long long)state.stats.gc.frame, (unsigned long long)state.stats.gc.heap / 1024);
+
+        if(state.stats.heap.peak)
+            printf("heap: %llu KB peak\n", (unsigned long long)state.stats.heap.peak / 1024);
+
+        if(hashFile)
+            fclose(hashFile);
+    }
+
+    free(cart);
+
+    return state.error ? 1 : 0;
+}
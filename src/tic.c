@@ -65,13 +65,9 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
     tic_api_reset(mem);
 }
 
-TIC80_API void tic80_tick(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq)
+static tic_tick_data tickData(tic80* tic, CounterCallback counter, FreqCallback freq)
 {
-    tic_mem* mem = (tic_mem*)tic;
-
-    mem->ram->input = input;
-
-    tic_tick_data tickData = (tic_tick_data)
+    return (tic_tick_data)
     {
         .error = onError,
         .trace = onTrace,
@@ -81,11 +77,24 @@ TIC80_API void tic80_tick(tic80* tic, tic80_input input, CounterCallback counter
         .counter = counter,
         .freq = freq
     };
+}
+
+static void tick(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq)
+{
+    tic_mem* mem = (tic_mem*)tic;
+    tic_tick_data data = tickData(tic, counter, freq);
+
+    mem->ram->input = input;
 
     tic_core_tick_start(mem);
-    tic_core_tick(mem, &tickData);
+    tic_core_tick(mem, &data);
     tic_core_tick_end(mem);
-    tic_core_blit(mem);
+}
+
+TIC80_API void tic80_tick(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq)
+{
+    tick(tic, input, counter, freq);
+    tic_core_blit((tic_mem*)tic);
 }
 
 TIC80_API void tic80_sound(tic80* tic)
@@ -94,8 +103,29 @@ TIC80_API void tic80_sound(tic80* tic)
     tic_core_synth_sound(mem);
 }
 
+TIC80_API void tic80_step(tic80* tic, tic80_input input, CounterCallback counter, FreqCallback freq, u32 flags)
+{
+    tic_mem* mem = (tic_mem*)tic;
+    tic_tick_data data = tickData(tic, counter, freq);
+
+    mem->ram->input = input;
+    tic_core_step(mem, &data, flags);
+}
+
 TIC80_API void tic80_delete(tic80* tic)
 {
     tic_mem* mem = (tic_mem*)tic;
     tic_core_close(mem);
 }
+
+TIC80_API void tic80_perspective(tic80* tic, s32 span)
+{
+    tic_mem* mem = (tic_mem*)tic;
+    tic_core_perspective(mem, span);
+}
+
+TIC80_API void tic80_gc(tic80* tic, s32 budget)
+{
+    tic_mem* mem = (tic_mem*)tic;
+    tic_core_gc(mem, budget);
+}
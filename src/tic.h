@@ -516,6 +516,7 @@ typedef struct
 
     tic_code code;
     tic_binary binary;
+    tic_binary bytecode; // code precompiled by the script runtime, see tic_core_bytecode_store
     u8 lang;
 
 } tic_cartridge;
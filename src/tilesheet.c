@@ -52,6 +52,7 @@ static const tic_blit_segment segments[] = {
 
 extern u8 tic_tilesheet_getpix(const tic_tilesheet* sheet, s32 x, s32 y);
 extern void tic_tilesheet_setpix(const tic_tilesheet* sheet, s32 x, s32 y, u8 value);
+extern u32 tic_tilesheet_bpp(const tic_blit_segment* segment);
 extern u8 tic_tilesheet_gettilepix(const tic_tileptr* tile, s32 x, s32 y);
 extern void tic_tilesheet_settilepix(const tic_tileptr* tile, s32 x, s32 y, u8 value);
 
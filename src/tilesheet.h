@@ -72,6 +72,11 @@ inline void tic_tilesheet_setpix(const tic_tilesheet* sheet, s32 x, s32 y, u8 va
     sheet->segment->poke(sheet->ptr + tile_index * sheet->segment->ptr_size, pix_addr, value);
 }
 
+inline u32 tic_tilesheet_bpp(const tic_blit_segment* segment)
+{
+    return segment->ptr_size * BITS_IN_BYTE / (segment->tile_width * TIC_SPRITESIZE);
+}
+
 inline u8 tic_tilesheet_gettilepix(const tic_tileptr* tile, s32 x, s32 y)
 {
     u32 addr = tile->offset + x + (y * tile->segment->tile_width);
@@ -210,6 +210,10 @@ const uint32_t WASM_FREE_RAM_SIZE = 163840; // 160kb
 //      Drawing Functions
 // ---------------------------
 
+WASM_IMPORT("batch")
+// Draw a list of commands in one call, see the batch() docs for the opcodes.
+int32_t batch(const float* commands, int32_t count);
+
 WASM_IMPORT("circ")
 // Draw a filled circle.
 void circ(int32_t x, int32_t y, int32_t radius, int8_t color);
@@ -230,6 +234,10 @@ WASM_IMPORT("clip")
 // Set the screen clipping region.
 void clip(int32_t x, int32_t y, int32_t width, int32_t height);
 
+WASM_IMPORT("canvas")
+// Redirect drawing to the sprite sheet block of w*h tiles at id, canvas(-1, -1, -1) packs it there.
+bool canvas(int32_t id, int32_t w, int32_t h);
+
 WASM_IMPORT("cls")
 // Clear the screen.
 void cls(int8_t color);
@@ -246,6 +254,10 @@ WASM_IMPORT("map")
 // Draw a map region.
 void map(int32_t x, int32_t y, int32_t w, int32_t h, int32_t sx, int32_t sy, uint8_t* trans_colors, int8_t colorCount, int8_t scale, int32_t remap);
 
+WASM_IMPORT("remap")
+// Replace a tile drawn by map(), optionally cycling through frames tiles every ticks frames, remap(-1, ...) clears all.
+bool remap(int32_t tile, int32_t index, int8_t flip, int8_t rotate, int32_t frames, int32_t ticks);
+
 WASM_IMPORT("pix")
 // Get or set the color of a single pixel.
 uint8_t pix(int32_t x, int32_t y, int8_t color);
@@ -354,6 +366,10 @@ WASM_IMPORT("poke4")
 // Write a nibble value to an address in RAM.
 void poke4(int32_t address, int8_t value);
 
+WASM_IMPORT("raster")
+// Write a VRAM byte before the fullscreen row is drawn, a negative row clears the table.
+int32_t raster(int32_t row, int32_t address, int32_t value);
+
 WASM_IMPORT("sync")
 // Copy banks of RAM (sprites, map, etc) to and from the cartridge.
 void sync(int32_t mask, int8_t bank, int8_t to_cart);
@@ -368,11 +384,11 @@ int8_t vbank(int8_t bank);
 
 WASM_IMPORT("fget")
 // Retrieve a sprite flag.
-bool fget(int32_t sprite_index, int8_t flag);
+bool fget(int32_t sprite_index, int32_t flag);
 
 WASM_IMPORT("fset")
 // Update a sprite flag.
-bool fset(int32_t sprite_index, int8_t flag, bool value);
+bool fset(int32_t sprite_index, int32_t flag, bool value);
 
 WASM_IMPORT("mget")
 // Retrieve a map tile at given coordinates.
@@ -382,6 +398,30 @@ WASM_IMPORT("mset")
 // Update a map tile at given coordinates.
 void mset(int32_t x, int32_t y, int32_t value);
 
+WASM_IMPORT("mflag")
+// Check if any map tile under a rectangle of pixels has a sprite flag set.
+bool mflag(int32_t x, int32_t y, int32_t w, int32_t h, int32_t flag);
+
+WASM_IMPORT("mray")
+// Find the first map tile with a sprite flag set along a line in pixels, returns x + y * 240 or -1.
+int32_t mray(float x0, float y0, float x1, float y1, int32_t flag);
+
+WASM_IMPORT("mrect")
+// Copy the tile ids of a map rectangle row by row, tiles must hold w * h bytes.
+int32_t mrect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t* tiles);
+
+WASM_IMPORT("path")
+// Find the shortest path between two map cells avoiding a sprite flag, cells must hold up to 32640 entries (x + y * 240).
+int32_t path(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t flag, uint16_t* cells);
+
+WASM_IMPORT("flow")
+// Compute the distances of all map cells to the target, returns the number of reachable cells.
+int32_t flow(int32_t x, int32_t y, int32_t flag);
+
+WASM_IMPORT("flowstep")
+// Get the next cell towards the last flow() target, returns x + y * 240 or -1.
+int32_t flowstep(int32_t x, int32_t y);
+
 // ---------------------------
 //      System Functions
 // ---------------------------